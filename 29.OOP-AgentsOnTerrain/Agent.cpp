@@ -21,51 +21,118 @@
 
 Agent::Agent(): Object(-1)
 {
+	bindMotion(NULL, 0);
+
   // setting standard movement, rotation speed
-	fAngle = 0;
-	fCurrAngle = 0;
+	fAngle() = 0;
+	fCurrAngle() = 0;
 	fAngleSpeed = 0.1f;
-	fMaxAngle = 5.0f;		// increased max angle now
-	fSpeed = 0.001f;
-	fMaxSpeed = 0.1f;
-	fMovement = 0.0f;
-	fFriction = 0.99f;
+	fMaxAngle() = 5.0f;		// increased max angle now
+	fSpeed() = 0.001f;
+	fMaxSpeed() = 0.1f;
+	fMovement() = 0.0f;
+	fFriction() = 0.99f;
 	fScale = 1.0f;
 
-	isForward = isBackward = isRight = isLeft = false;
+	isForward() = isBackward() = isRight() = isLeft() = false;
+	isMoving = false;
+
+	vPos().x = 0.0f;
+	vPos().y = 0.0f;
+	vPos().z = 0.0f;
+
+	_spatialHash = NULL;
+	_positions = NULL;
+
+	_seed = 0;
+	_tick = NULL;
 
-	vPos.x = 0.0f;
-	vPos.y = 0.0f;
-	vPos.z = 0.0f;
+	vPrevPos = vPos();
+	fPrevAngle = fCurrAngle();
+	_renderAlpha = NULL;
+
+	handle = NO_AGENT;
+	_pools = NULL;
+	_interactions = NULL;
+	index = -1;
+	dying = false;
+
+	fBasisAngle() = NAN;		// nothing cached yet
+	dCosHeading() = 1.0;
+	dSinHeading() = 0.0;
 }
 
-Agent::Agent(int _id, float origX, float origY, float origZ, float speed): Object(_id)
+Agent::Agent(int _id, float origX, float origY, float origZ, float speed, Population *population, int slot): Object(_id)
 {
+	bindMotion(population, slot);
+
   // setting standard movement, rotation speed
-	fAngle = 0;
-	fCurrAngle = 0;
+	fAngle() = 0;
+	fCurrAngle() = 0;
 	fAngleSpeed = 0.1f;
-	fMaxAngle = 5.0f;		// increased max angle now
-	fSpeed = speed;
-	fMaxSpeed = 0.1f;
-	fMovement = 0.0f;
-	fFriction = 0.99f;
+	fMaxAngle() = 5.0f;		// increased max angle now
+	fSpeed() = speed;
+	fMaxSpeed() = 0.1f;
+	fMovement() = 0.0f;
+	fFriction() = 0.99f;
 
 	fScale = 1.0f;
 
-	isForward = isBackward = isRight = isLeft = false;
+	isForward() = isBackward() = isRight() = isLeft() = false;
+	isMoving = false;
+
+	vPos().x = origX;
+	vPos().y = origY;
+	vPos().z = origZ;
 
-	vPos.x = origX;
-	vPos.y = origY;
-	vPos.z = origZ;
+	_spatialHash = NULL;
+	_positions = NULL;
+
+	_seed = 0;
+	_tick = NULL;
+
+	vPrevPos = vPos();
+	fPrevAngle = fCurrAngle();
+	_renderAlpha = NULL;
+
+	handle = NO_AGENT;
+	_pools = NULL;
+	_interactions = NULL;
+	index = -1;
+	dying = false;
+
+	fBasisAngle() = NAN;		// nothing cached yet
+	dCosHeading() = 1.0;
+	dSinHeading() = 0.0;
 }
 
 Agent::~Agent()
 {
+	if (_ownsMotion) delete _motion;
+	_motion = NULL;
 	_grid = NULL;
 	_agents = NULL;
 	_terrain = NULL;
-  cout<<"Agent destroyed!"<<endl;
+	_spatialHash = NULL;
+	_positions = NULL;
+	_tick = NULL;
+	_renderAlpha = NULL;
+	_pools = NULL;
+	_interactions = NULL;
+}
+
+void Agent::bindMotion(Population *population, int slot)
+{
+	_ownsMotion = (population == NULL);
+	if (_ownsMotion)
+	{
+		population = new Population(1);
+		population->use(0);
+		slot = 0;
+	}
+
+	_motion = population;
+	_slot = slot;
 }
 
 // void Agent::setBoundary(float top, float bottom, float left, float right)
@@ -89,9 +156,12 @@ void Agent::render()
 		matPos.identity();
 
 		// set translation and rotation matrix
-		matPos.translate(vPos.x, vPos.y, vPos.z);
+		Vector3f pos = getRenderPosition();
+		matPos.translate(pos.x, pos.y, pos.z);
 		//fCurrAngle += 0.11f;
-		matRot.rotateY(fCurrAngle);
+		float c, s;
+		getRenderBasis(c, s);
+		matRot.rotateY(c, s);
 
 		// load position matrix and add rotation
 		//glLoadMatrixf(matPos.matrix);
@@ -105,44 +175,52 @@ void Agent::update()
 {
 	autonomy();
 
-	if(isForward)
+	integrate();
+
+	//cout<<vPos.x<< " "<<vPos.z<<" m:"<<fMovement<<endl;
+	//cout<<" isForward:"<<isForward<<" isBackward"<<isBackward<<" isLeft:"<<isLeft<<" isRight:"<<isRight<<endl;
+
+	placeAgentOnTerrain();
+}
+
+// apply thrust, friction and turning, then advance along the heading
+// Population::integrateMotion() is the batch version of this function
+void Agent::integrate()
+{
+	if(isForward())
 	{
-		fMovement -= fSpeed;
-		if (fMovement <= -fMaxSpeed) fMovement = -fMaxSpeed;
-		if (fMovement >= -0.0001) { fMovement = 0.0f; isForward = false; }
+		fMovement() -= fSpeed();
+		if (fMovement() <= -fMaxSpeed()) fMovement() = -fMaxSpeed();
+		if (fMovement() >= -0.0001) { fMovement() = 0.0f; isForward() = false; }
 	}
 
-	if(isBackward)
+	if(isBackward())
 	{
-		fMovement += fSpeed;
-		if (fMovement >= fMaxSpeed) fMovement = fMaxSpeed;
-		if (fMovement <= 0.0001) { fMovement = 0.0f; isBackward = false; }
+		fMovement() += fSpeed();
+		if (fMovement() >= fMaxSpeed()) fMovement() = fMaxSpeed();
+		if (fMovement() <= 0.0001) { fMovement() = 0.0f; isBackward() = false; }
 	}
-	fMovement *= fFriction; // friction has to be outside to reduce the movement to a halt
+	fMovement() *= fFriction(); // friction has to be outside to reduce the movement to a halt
 
-	if(isRight)
+	if(isRight())
 	{
-		if (fAngle >= fMaxAngle) fAngle = fMaxAngle;
-		fAngle *= fFriction;
-		if (fAngle <= 0.001f) fAngle = 0.0f;
+		if (fAngle() >= fMaxAngle()) fAngle() = fMaxAngle();
+		fAngle() *= fFriction();
+		if (fAngle() <= 0.001f) fAngle() = 0.0f;
 	}
 
-	if (isLeft)
+	if (isLeft())
 	{
-		if (fAngle <= -fMaxAngle) fAngle = -fMaxAngle;
-		fAngle *= fFriction;
-		if (fAngle >= -0.001f) fAngle = 0.0f;
+		if (fAngle() <= -fMaxAngle()) fAngle() = -fMaxAngle();
+		fAngle() *= fFriction();
+		if (fAngle() >= -0.001f) fAngle() = 0.0f;
 	}
 
-	fCurrAngle += fAngle;
-
-	vPos.x -= fMovement*cos(fCurrAngle * PI/180);
-	vPos.z -= fMovement*sin(fCurrAngle * PI/180);
-
-	//cout<<vPos.x<< " "<<vPos.z<<" m:"<<fMovement<<endl;
-	//cout<<" isForward:"<<isForward<<" isBackward"<<isBackward<<" isLeft:"<<isLeft<<" isRight:"<<isRight<<endl;
+	fCurrAngle() += fAngle();
 
-	placeAgentOnTerrain();
+	updateHeadingBasis();
+	vPos().x -= fMovement()*dCosHeading();
+	vPos().z -= fMovement()*dSinHeading();
 }
 
 void Agent::autonomy()
@@ -150,7 +228,7 @@ void Agent::autonomy()
 	// simulating erratic behaviour by randomising decisions
 
 	// generate a random boolean value
-	int r = rand() % 2;
+	int r = random(STREAM_TURN, 2);
 
 	if(r == 0)
 	{
@@ -162,14 +240,14 @@ void Agent::autonomy()
 	}
 
 	// get another random value for thrust
-	r = rand() % 2;
+	r = random(STREAM_THRUST, 2);
 	if(r == 0)
 	{
 		moveForward(2.0f);
 	}
 
 	// check boundary and try not to leave!
-	if (_grid->isInBoundary(vPos, 2.0f) == false)
+	if (_grid->isInBoundary(vPos(), 2.0f) == false)
 	{
 		rotateLeft(5.0f);
 	}
@@ -189,61 +267,135 @@ void Agent::getAgents(Agent **agents, int size)
 
 Vector3f Agent::getPosition()
 {
-	return Vector3f(vPos.x, vPos.y, vPos.z);
+	return Vector3f(vPos().x, vPos().y, vPos().z);
+}
+
+float Agent::getHeading()
+{
+	return fCurrAngle();
+}
+
+float Agent::getSpeed()
+{
+	return fSpeed();
+}
+
+void Agent::savePrevious()
+{
+	vPrevPos = vPos();
+	fPrevAngle = fCurrAngle();
+}
+
+Vector3f Agent::getRenderPosition()
+{
+	if (_renderAlpha == NULL || *_renderAlpha >= 1.0f) return vPos();
+
+	float a = *_renderAlpha;
+	return Vector3f(vPrevPos.x + (vPos().x - vPrevPos.x) * a,
+	                vPrevPos.y + (vPos().y - vPrevPos.y) * a,
+	                vPrevPos.z + (vPos().z - vPrevPos.z) * a);
+}
+
+float Agent::getRenderHeading()
+{
+	if (_renderAlpha == NULL || *_renderAlpha >= 1.0f) return fCurrAngle();
+
+	return fPrevAngle + (fCurrAngle() - fPrevAngle) * *_renderAlpha;
+}
+
+void Agent::getState(AGENTSTATE &state)
+{
+	state.x = vPos().x;
+	state.y = vPos().y;
+	state.z = vPos().z;
+	state.heading = fCurrAngle();
+	state.prevX = vPrevPos.x;
+	state.prevY = vPrevPos.y;
+	state.prevZ = vPrevPos.z;
+	state.prevHeading = fPrevAngle;
+}
+
+// the compiler turns the cos and sin of the same angle into one sincos call
+void Agent::updateHeadingBasis()
+{
+	if (fCurrAngle() == fBasisAngle()) return;
+
+	fBasisAngle() = fCurrAngle();
+	dCosHeading() = cos(fCurrAngle() * PI/180);
+	dSinHeading() = sin(fCurrAngle() * PI/180);
+}
+
+void Agent::faceHeading()
+{
+	updateHeadingBasis();
+	perception.face(dCosHeading(), dSinHeading());
+}
+
+void Agent::getRenderBasis(float &cosHeading, float &sinHeading)
+{
+	if (_renderAlpha == NULL || *_renderAlpha >= 1.0f)
+	{
+		updateHeadingBasis();
+		cosHeading = dCosHeading();
+		sinHeading = dSinHeading();
+		return;
+	}
+
+	float angle = getRenderHeading() * PI/180;
+	cosHeading = cos(angle);
+	sinHeading = sin(angle);
 }
 
 void Agent::rotateLeft(float fAngleSpeed)
 {
-	fAngle -= fAngleSpeed;
-	isLeft = true;
-	isRight = false;
+	fAngle() -= fAngleSpeed;
+	isLeft() = true;
+	isRight() = false;
 }
 
 void Agent::rotateRight(float fAngleSpeed)
 {
-	fAngle += fAngleSpeed;
-	isRight = true;
-	isLeft = false;
+	fAngle() += fAngleSpeed;
+	isRight() = true;
+	isLeft() = false;
 }
 
 void Agent::moveForward(float speed)
 {
-  fSpeed = speed;
-	isForward = true;
-	isBackward = false;
+  fSpeed() = speed;
+	isForward() = true;
+	isBackward() = false;
 }
 
 void Agent::moveBackward(float speed)
 {
-  fSpeed = speed;
+  fSpeed() = speed;
 
-	isBackward = true;
-	isForward = false;
+	isBackward() = true;
+	isForward() = false;
 }
 
 void Agent::stopForward()
 {
-	isForward = false;
+	isForward() = false;
 }
 
 void Agent::stopBackward()
 {
-  isBackward = false;
+  isBackward() = false;
 }
 
 void Agent::notMoving()
 {
-  isForward = false;
-  isBackward = false;
+  isForward() = false;
+  isBackward() = false;
 }
 void Agent::placeAgentOnTerrain()
 {
+	PROFILE("placeAgentOnTerrain");
+
 	// skate on top of terrain
-	float dist = _terrain->distanceToPlane(vPos);
-	if (dist <= 0.0)	// the box is under the plane
-		vPos.y = vPos.y + fabs(dist);
-	else
-		vPos.y = vPos.y - fabs(dist);
+	vPos().y = _terrain->sampleHeight(vPos().x, vPos().z);
 }
 
 void Agent::getTerrain(SimpleTerrain *terrain)
@@ -251,6 +403,167 @@ void Agent::getTerrain(SimpleTerrain *terrain)
 	_terrain = terrain;
 }
 
+void Agent::getSpatialHash(SpatialHash *spatialHash)
+{
+	_spatialHash = spatialHash;
+}
+
+void Agent::getPositionBuffer(PositionBuffer *positions)
+{
+	_positions = positions;
+}
+
+void Agent::getRandom(unsigned int seed, const long *tick)
+{
+	_seed = seed;
+	_tick = tick;
+}
+
+void Agent::getRenderAlpha(const float *alpha)
+{
+	_renderAlpha = alpha;
+}
+
+void Agent::getPools(AgentPoolBase **pools)
+{
+	_pools = pools;
+}
+
+void Agent::getInteractions(InteractionBuffer *interactions)
+{
+	_interactions = interactions;
+}
+
+void Agent::emit(InteractionType type, int target)
+{
+	if(_interactions == NULL) return;
+
+	INTERACTION event;
+	event.type = type;
+	event.actor = id;
+	event.target = target;
+	_interactions->push(event);
+}
+
+AgentHandle Agent::getHandle()
+{
+	return handle;
+}
+
+Agent *Agent::resolve(SpeciesType species, AgentHandle h)
+{
+	if(_pools == NULL) return NULL;
+
+	return _pools[species]->get(h);
+}
+
+int Agent::random(RandomStream stream, int n)
+{
+	long tick = (_tick != NULL) ? *_tick : 0;
+	return Random::range(_seed, id, tick, stream, n);
+}
+
+// where another agent is, as far as this agent is concerned
+Vector3f Agent::positionOf(int i)
+{
+	if(_positions != NULL)
+		return _positions->front[i];		// last tick's snapshot
+
+	return _agents[i]->getPosition();
+}
+
+// perception must face fCurrAngle
+bool Agent::isVisible(const Vector3f &pos, int i, float range2, float fov)
+{
+	return perception.sees(pos, positionOf(i), range2, fov);
+}
+
+int Agent::findTarget(SpeciesType species, float range, float fov)
+{
+	PROFILE("seek");
+
+	faceHeading();
+	float range2 = range * range;
+	Vector3f pos = vPos();
+
+	if(_spatialHash == NULL)
+	{
+		// brute force: test every agent in the world
+		for(int i = 0; i < _noOfAgents; i++)
+			if(_agents[i]->speciesType == species)
+				if(isVisible(pos, i, range2, fov))
+					return i;
+
+		return -1;
+	}
+
+	// only visit the cells overlapping the seek radius
+	int x0, z0, x1, z1;
+	_spatialHash->cellRange(pos.x, pos.z, range, x0, z0, x1, z1);
+
+	int target = -1;
+	for(int cz = z0; cz <= z1; cz++)
+	{
+		for(int cx = x0; cx <= x1; cx++)
+		{
+			int end = _spatialHash->cellEnd(species, cx, cz);
+			for(int k = _spatialHash->cellBegin(species, cx, cz); k < end; k++)
+			{
+				int i = _spatialHash->item(k);
+
+				// cells are sorted by index, nothing after this can beat target
+				if(target != -1 && i > target) break;
+
+				if(isVisible(pos, i, range2, fov))
+				{
+					target = i;
+					break;
+				}
+			}
+		}
+	}
+
+	// the lowest index wins, the same agent the brute-force loop picks
+	return target;
+}
+
+int Agent::findVisible(SpeciesType species, float range, float fov, int *targets, int maxTargets)
+{
+	PROFILE("findVisible");
+
+	faceHeading();
+	float range2 = range * range;
+	Vector3f pos = vPos();
+	int found = 0;
+
+	if(_spatialHash == NULL)
+	{
+		for(int i = 0; i < _noOfAgents && found < maxTargets; i++)
+			if(_agents[i]->speciesType == species)
+				if(isVisible(pos, i, range2, fov))
+					targets[found++] = i;
+
+		return found;
+	}
+
+	int x0, z0, x1, z1;
+	_spatialHash->cellRange(pos.x, pos.z, range, x0, z0, x1, z1);
+
+	for(int cz = z0; cz <= z1; cz++)
+		for(int cx = x0; cx <= x1; cx++)
+		{
+			int end = _spatialHash->cellEnd(species, cx, cz);
+			for(int k = _spatialHash->cellBegin(species, cx, cz); k < end && found < maxTargets; k++)
+			{
+				int i = _spatialHash->item(k);
+				if(isVisible(pos, i, range2, fov))
+					targets[found++] = i;
+			}
+		}
+
+	return found;
+}
+
 void Agent::DrawObject(float red, float green, float blue)
 {
 	glColor3f(red, green, blue);		// set colour to red
@@ -26,24 +26,61 @@
 #include "Object.h"
 #include "Category.h" // for managing agent types during simulation
 #include "SimpleTerrain.h"
+#include "SpatialHash.h"
+#include "PositionBuffer.h"
+#include "AgentPool.h"
+#include "Perception.h"
+#include "Interaction.h"
+#include "Snapshot.h"
+#include "Random.h"
+#include "Profiler.h"
 
 /****************************** PROTOTYPES ******************************/
 class Agent: public Object
 {
+  // checkpoints copy the movement variables to and from a file
+  friend class Checkpoint;
+  // pools hand out the handle
+  template <class T> friend class AgentPool;
+
 protected:
-  // movement variables
-  float fAngle, fCurrAngle, fAngleSpeed, fMaxAngle;
-	float fSpeed, fMaxSpeed;
-	float fMovement, fFriction;
+  // movement variables live in a Population (see Population.h), this
+  // agent is slot _slot of it
+  Population *_motion;
+  int _slot;
+  bool _ownsMotion;     // a Population of one, the agent was made without a pool
+  void bindMotion(Population *population, int slot);   // NULL: make that one
+
+  float &fAngle() { return _motion->angularVelocity[_slot]; }
+  float &fCurrAngle() { return _motion->heading[_slot]; }
+  float &fMaxAngle() { return _motion->maxAngle[_slot]; }
+  float &fSpeed() { return _motion->speed[_slot]; }
+  float &fMaxSpeed() { return _motion->maxSpeed[_slot]; }
+  float &fMovement() { return _motion->movement[_slot]; }
+  float &fFriction() { return _motion->friction[_slot]; }
+
+  Vector3f &vPos() { return _motion->position[_slot]; }    // position of the object
+
+  // movement flags
+  unsigned char &isForward() { return _motion->isForward[_slot]; }
+  unsigned char &isBackward() { return _motion->isBackward[_slot]; }
+  unsigned char &isRight() { return _motion->isRight[_slot]; }
+  unsigned char &isLeft() { return _motion->isLeft[_slot]; }
+
+  float fAngleSpeed;
   float fScale; // scale of the graphical representation
 
   // Matrix and Vector transforms
 	Matrix4x4 matPos;  // position Matrix
 	Matrix4x4 matRot;  // rotation matrix
-	Vector3f 	vPos;    // position of the object
 
-  // movement flags
-	bool isForward, isBackward, isRight, isLeft, isMoving;
+  // where the agent was at the start of the tick, drawn between the two
+  // at the fraction *_renderAlpha of a tick (see SimulationClock.h)
+  Vector3f vPrevPos;
+  float fPrevAngle;
+  const float *_renderAlpha;
+
+	bool isMoving;
 
   // internal reference to global grid
   Grid *_grid;
@@ -58,17 +95,61 @@ protected:
   // access to terrain using pointer
   SimpleTerrain *_terrain;
 
+  // optional spatial index of all agents, NULL falls back to a full scan
+  SpatialHash *_spatialHash;
+
+  // optional snapshot of last tick's positions, NULL reads agents directly
+  PositionBuffer *_positions;
+  Vector3f positionOf(int i);
+
+  // where this agent lives in its species' pool
+  AgentHandle handle;
+
+  // the pools of all species, to turn a handle back into an agent
+  AgentPoolBase **_pools;
+  Agent *resolve(SpeciesType species, AgentHandle h);    // NULL if it has died
+
+  // what this agent wants to do to others, resolved by World after the
+  // tick (NULL outside a World: the intents go nowhere)
+  InteractionBuffer *_interactions;
+  void emit(InteractionType type, int target);   // target: agents array index
+
+  // random numbers are a function of (seed, id, tick, stream), see Random.h
+  unsigned int _seed;
+  const long *_tick;     // the world's tick counter
+  int random(RandomStream stream, int n);   // in [0, n)
+
+  // cos and sin of fCurrAngle, worked out again only when the heading
+  // has changed since they were last needed (movement, seeing, drawing)
+  float &fBasisAngle() { return _motion->basisAngle[_slot]; }
+  double &dCosHeading() { return _motion->cosHeading[_slot]; }
+  double &dSinHeading() { return _motion->sinHeading[_slot]; }
+  void updateHeadingBasis();
+
+  // the heading as a basis, for seeing many agents at once
+  Perception perception;
+  void faceHeading();     // point perception along fCurrAngle
+
+  // index of the lowest numbered agent of a species within range and FOV
+  // returns -1 if no agent is visible
+  int findTarget(SpeciesType species, float range, float fov);
+  bool isVisible(const Vector3f &pos, int i, float range2, float fov);   // from pos, range squared
+
+
 public:
   // ------------------- constructors destructors
+  // an AgentPool passes the Population and slot of the movement variables
   Agent();
-  Agent(int _id, float origX, float origY, float origZ, float speed);
+  Agent(int _id, float origX, float origY, float origZ, float speed, Population *population = NULL, int slot = 0);
   ~Agent();
 
   // ------------------- update functions
   virtual void render();
   virtual void update();
+  void integrate();   // movement step of update()
   SpeciesType speciesType;
-
+  int index;      // in the world's agents array, changes when agents die
+  bool dying;     // World::kill() was called, it goes after this tick
 
   // ------------------- agent functions
   virtual void autonomy();
@@ -77,14 +158,32 @@ public:
   void getAgents(Agent **agents, int size);
 
   void getTerrain(SimpleTerrain *terrain);
+  void getSpatialHash(SpatialHash *spatialHash);
+  void getPositionBuffer(PositionBuffer *positions);
+  void getRandom(unsigned int seed, const long *tick);
+  void getRenderAlpha(const float *alpha);
+  void getPools(AgentPoolBase **pools);
+  void getInteractions(InteractionBuffer *interactions);
+  AgentHandle getHandle();
 
   // to be implemented in derived classes
   virtual void seek() {};
   virtual void chase() {};
-  virtual void isEaten() {}; // ** new member in this Agent implementation
+  virtual void isEaten(int byId) {}; // ** new member in this Agent implementation
+
+  // indices of up to maxTargets agents of a species within range and FOV,
+  // in no particular order, returns how many were found
+  int findVisible(SpeciesType species, float range, float fov, int *targets, int maxTargets);
 
   // ------------------- movement functions
   Vector3f getPosition();
+  float getHeading();
+  float getSpeed();
+  void savePrevious();            // at the start of every tick
+  Vector3f getRenderPosition();   // between the previous and current position
+  float getRenderHeading();
+  void getRenderBasis(float &cosHeading, float &sinHeading);   // of getRenderHeading()
+  void getState(AGENTSTATE &state);   // both positions and headings, for a WorldSnapshot
   void rotateLeft(float fAngleSpeed);
   void rotateRight(float fAngleSpeed);
   void moveForward(float speed);
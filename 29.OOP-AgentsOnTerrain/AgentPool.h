@@ -0,0 +1,194 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ Agent Pool and Agent Handles
+//
+//	Agents are born and die while the simulation runs. Allocating
+//	each one with new and delete scatters them over the heap and
+//	costs a trip to the allocator per birth and per death. A pool
+//	holds one species in chunks of AGENTPOOL_CHUNK objects: a death
+//	puts the slot on a free list, the next birth takes it back. The
+//	chunks are never moved, so an agent stays where it was born.
+//	The movement variables of the species are kept apart from the
+//	objects, in a Population indexed by the same slot.
+//
+//	An index into the agents array is not a safe way to remember
+//	another agent, the array is compacted when agents die. A handle
+//	is the slot in the pool and the slot's generation, which goes up
+//	every time the slot is freed: a handle to an agent that has died
+//	no longer matches and get() returns NULL, even when the slot
+//	already holds a newborn.
+//
+//	##########################################################
+
+#ifndef AGENTPOOL_H
+#define AGENTPOOL_H
+
+#include <new>
+#include <string.h>
+
+#include "Population.h"
+
+class Agent;
+
+#define AGENTPOOL_CHUNK 1024		// objects per allocation
+
+struct AgentHandle
+{
+	int slot;								// -1 for no agent
+	unsigned int generation;
+};
+
+const AgentHandle NO_AGENT = {-1, 0};
+
+/****************************** PROTOTYPES ******************************/
+// handles of all species are looked up here, without knowing the type
+class AgentPoolBase
+{
+protected:
+	Agent **objects;				// [slot], NULL when the slot is free
+	unsigned int *generations;		// [slot]
+	int capacity;
+
+public:
+	int size;						// number of live agents
+
+	// the position, heading, speed and movement flags of every slot
+	Population motion;
+
+	AgentPoolBase(): motion(0)
+	{
+		objects = NULL;
+		generations = NULL;
+		capacity = 0;
+		size = 0;
+	}
+
+	virtual ~AgentPoolBase()
+	{
+		delete[] objects;
+		delete[] generations;
+	}
+
+	// the agent, or NULL if it has died (or handle is NO_AGENT)
+	Agent *get(AgentHandle handle) const
+	{
+		if (handle.slot < 0 || handle.slot >= capacity) return NULL;
+		if (generations[handle.slot] != handle.generation) return NULL;
+		return objects[handle.slot];
+	}
+};
+
+template <class T>
+class AgentPool: public AgentPoolBase
+{
+private:
+	unsigned char **chunks;
+	int noOfChunks;
+
+	int *freeSlots;				// a stack, the lowest slot on top
+	int noOfFree;
+
+	// one more chunk, the slot tables are copied over (rare)
+	void grow()
+	{
+		int newCapacity = capacity + AGENTPOOL_CHUNK;
+
+		Agent **newObjects = new Agent*[newCapacity];
+		unsigned int *newGenerations = new unsigned int[newCapacity];
+		int *newFreeSlots = new int[newCapacity];
+		unsigned char **newChunks = new unsigned char*[noOfChunks + 1];
+
+		if (capacity > 0)
+		{
+			memcpy(newObjects, objects, capacity * sizeof(Agent*));
+			memcpy(newGenerations, generations, capacity * sizeof(unsigned int));
+			memcpy(newFreeSlots, freeSlots, noOfFree * sizeof(int));
+			memcpy(newChunks, chunks, noOfChunks * sizeof(unsigned char*));
+		}
+
+		newChunks[noOfChunks] = (unsigned char *)::operator new(sizeof(T) * AGENTPOOL_CHUNK);
+		noOfChunks++;
+
+		// pushed from the top so that the lowest new slot is used first
+		for(int slot = newCapacity - 1; slot >= capacity; slot--)
+		{
+			newObjects[slot] = NULL;
+			newGenerations[slot] = 0;
+			newFreeSlots[noOfFree++] = slot;
+		}
+
+		delete[] objects;
+		delete[] generations;
+		delete[] freeSlots;
+		delete[] chunks;
+		motion.reserve(newCapacity);
+		objects = newObjects;
+		generations = newGenerations;
+		freeSlots = newFreeSlots;
+		chunks = newChunks;
+		capacity = newCapacity;
+	}
+
+public:
+	AgentPool()
+	{
+		chunks = NULL;
+		noOfChunks = 0;
+		freeSlots = NULL;
+		noOfFree = 0;
+	}
+
+	// room for count agents without allocating again
+	void reserve(int count)
+	{
+		while (capacity < count) grow();
+	}
+
+	// construct a T in a free slot, the arguments go to T's constructor
+	// followed by the Population and the slot its movement variables use
+	template <class... Args>
+	T *create(Args... args)
+	{
+		if (noOfFree == 0) grow();
+
+		int slot = freeSlots[--noOfFree];
+		unsigned char *memory = chunks[slot / AGENTPOOL_CHUNK] + sizeof(T) * (slot % AGENTPOOL_CHUNK);
+
+		motion.use(slot);
+		T *object = new (memory) T(args..., &motion, slot);
+		object->handle.slot = slot;
+		object->handle.generation = generations[slot];
+
+		objects[slot] = object;
+		size++;
+		return object;
+	}
+
+	// every handle to object is stale after this
+	void destroy(T *object)
+	{
+		int slot = object->handle.slot;
+		object->~T();
+		motion.clear(slot);
+
+		objects[slot] = NULL;
+		generations[slot]++;
+		freeSlots[noOfFree++] = slot;
+		size--;
+	}
+
+	~AgentPool()
+	{
+		for(int slot = 0; slot < capacity; slot++)
+			if (objects[slot] != NULL) ((T *)objects[slot])->~T();
+
+		for(int c = 0; c < noOfChunks; c++)
+			::operator delete(chunks[c]);
+		delete[] chunks;
+		delete[] freeSlots;
+	}
+};
+
+#endif
@@ -0,0 +1,313 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ Instanced Agent Renderer
+//
+//	See AgentRenderer.h for the rationale
+//
+//	##########################################################
+
+#include <stdio.h>
+#include <string.h>
+#include "AgentRenderer.h"
+
+// generic vertex attributes of the shader
+const GLuint ATTRIB_VERTEX = 0;
+const GLuint ATTRIB_INSTANCE = 1;
+
+// the vertex shader does what Predator::render() does with matPos and
+// matRot (Matrix4x4::rotateY then translate) for one instance
+static const char *vertexShaderSource =
+  "#version 120\n"
+  "attribute vec3 vertex;\n"
+  "attribute vec4 instance;\n"      // x, y, z, heading in degrees
+  "uniform vec3 colour;\n"
+  "void main()\n"
+  "{\n"
+  "  float a = radians(instance.w);\n"
+  "  float c = cos(a);\n"
+  "  float s = sin(a);\n"
+  "  vec3 p = vec3(c*vertex.x - s*vertex.z, vertex.y, s*vertex.x + c*vertex.z) + instance.xyz;\n"
+  "  gl_Position = gl_ModelViewProjectionMatrix * vec4(p, 1.0);\n"
+  "  gl_FrontColor = vec4(colour, 1.0);\n"
+  "  gl_BackColor = vec4(colour, 1.0);\n"
+  "}\n";
+
+static const char *fragmentShaderSource =
+  "#version 120\n"
+  "void main()\n"
+  "{\n"
+  "  gl_FragColor = gl_Color;\n"
+  "}\n";
+
+// ------------------------------------------ the shapes, fScale 1
+// the same vertices as Predator::DrawObject and Prey::DrawObject
+static const GLfloat moverTriangles[] = {
+  // right
+  0.0f, 0.5f, 0.0f,   0.0f, 0.0f, 0.5f,   1.0f, 0.0f, 0.0f,
+  // left
+  0.0f, 0.5f, 0.0f,   1.0f, 0.0f, 0.0f,   0.0f, 0.0f, -0.5f,
+  // back
+  0.0f, 0.5f, 0.0f,   0.0f, 0.0f, 0.5f,   0.0f, 0.0f, -0.5f,
+  // belly
+  0.0f, 0.5f, 0.0f,   0.0f, 0.0f, 0.5f,   0.0f, 0.0f, -0.5f
+};
+
+// predators have both lines, preys only the first (vertical) one
+static const GLfloat moverLines[] = {
+  -1.0f, 0.0f, 0.0f,   2.0f, 0.0f, 0.0f,
+  0.0f, 0.0f, -2.0f,   0.0f, 0.0f, 2.0f
+};
+
+// the same vertices as Snack::DrawObject
+static const GLfloat snackTriangles[] = {
+  // right
+  0.0f, 1.0f, 0.0f,   0.0f, 0.0f, 0.5f,   -0.5f, 0.0f, 0.0f,
+  // left
+  0.0f, 1.0f, 0.0f,   0.5f, 0.0f, 0.0f,   0.0f, 0.0f, 0.5f,
+  // back
+  0.0f, 1.0f, 0.0f,   0.5f, 0.0f, 0.0f,   0.0f, 0.0f, -0.5f,
+  // belly
+  0.0f, 1.0f, 0.0f,   0.0f, 0.0f, -0.5f,  -0.5f, 0.0f, 0.0f
+};
+
+AgentRenderer::AgentRenderer()
+{
+  program = 0;
+  meshBuffer = 0;
+  for(int s=0; s<NO_OF_SPECIES; s++)
+  {
+    meshes[s].instanceBuffer = 0;
+    meshes[s].capacity = 0;
+  }
+
+  ready = buildProgram();
+  if (!ready)
+  {
+    cout<<">> AgentRenderer: no instanced drawing, agents are drawn one by one"<<endl;
+    return;
+  }
+
+  buildMeshes();
+}
+
+// compile and link the shader, false if the context cannot run it
+bool AgentRenderer::buildProgram()
+{
+  // glDrawArraysInstanced is OpenGL 3.1, glVertexAttribDivisor 3.3 (or the extension)
+  const char *version = (const char *)glGetString(GL_VERSION);
+  int major = 0, minor = 0;
+  if (version == NULL || sscanf(version, "%d.%d", &major, &minor) != 2)
+    return false;
+
+  const char *extensions = (const char *)glGetString(GL_EXTENSIONS);
+  bool divisor = major > 3 || (major == 3 && minor >= 3) ||
+    (extensions != NULL && strstr(extensions, "GL_ARB_instanced_arrays") != NULL);
+  if (major < 3 || (major == 3 && minor < 1) || !divisor)
+    return false;
+
+  GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+  glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
+  glCompileShader(vertexShader);
+
+  GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+  glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
+  glCompileShader(fragmentShader);
+
+  program = glCreateProgram();
+  glAttachShader(program, vertexShader);
+  glAttachShader(program, fragmentShader);
+  glBindAttribLocation(program, ATTRIB_VERTEX, "vertex");
+  glBindAttribLocation(program, ATTRIB_INSTANCE, "instance");
+  glLinkProgram(program);
+
+  // the program keeps the shaders alive as long as it needs them
+  glDeleteShader(vertexShader);
+  glDeleteShader(fragmentShader);
+
+  GLint linked = GL_FALSE;
+  glGetProgramiv(program, GL_LINK_STATUS, &linked);
+  if (linked != GL_TRUE)
+  {
+    char log[1024];
+    glGetProgramInfoLog(program, sizeof(log), NULL, log);
+    cout<<">> AgentRenderer: shader failed: "<<log<<endl;
+    glDeleteProgram(program);
+    program = 0;
+    return false;
+  }
+
+  colourLocation = glGetUniformLocation(program, "colour");
+  return true;
+}
+
+// all shapes go into one buffer, uploaded once
+void AgentRenderer::buildMeshes()
+{
+  int moverTriangleVertices = sizeof(moverTriangles) / (3 * sizeof(GLfloat));
+  int moverLineVertices = sizeof(moverLines) / (3 * sizeof(GLfloat));
+  int snackTriangleVertices = sizeof(snackTriangles) / (3 * sizeof(GLfloat));
+
+  // layout: mover triangles, mover lines, snack triangles
+  glGenBuffers(1, &meshBuffer);
+  glBindBuffer(GL_ARRAY_BUFFER, meshBuffer);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(moverTriangles) + sizeof(moverLines) + sizeof(snackTriangles), NULL, GL_STATIC_DRAW);
+  glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(moverTriangles), moverTriangles);
+  glBufferSubData(GL_ARRAY_BUFFER, sizeof(moverTriangles), sizeof(moverLines), moverLines);
+  glBufferSubData(GL_ARRAY_BUFFER, sizeof(moverTriangles) + sizeof(moverLines), sizeof(snackTriangles), snackTriangles);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  SPECIESMESH &predator = meshes[PREDATOR];
+  predator.firstTriangleVertex = 0;
+  predator.noOfTriangleVertices = moverTriangleVertices;
+  predator.firstLineVertex = moverTriangleVertices;
+  predator.noOfLineVertices = moverLineVertices;
+  predator.pointVertex = 0;
+  predator.red = 1.0f; predator.green = 0.0f; predator.blue = 0.0f;
+
+  SPECIESMESH &prey = meshes[PREY];
+  prey.firstTriangleVertex = 0;
+  prey.noOfTriangleVertices = moverTriangleVertices;
+  prey.firstLineVertex = moverTriangleVertices;
+  prey.noOfLineVertices = 2;
+  prey.pointVertex = 0;
+  prey.red = 0.0f; prey.green = 0.0f; prey.blue = 1.0f;
+
+  SPECIESMESH &snack = meshes[SNACK];
+  snack.firstTriangleVertex = moverTriangleVertices + moverLineVertices;
+  snack.noOfTriangleVertices = snackTriangleVertices;
+  snack.firstLineVertex = 0;
+  snack.noOfLineVertices = 0;
+  snack.pointVertex = snack.firstTriangleVertex;
+  snack.red = 0.0f; snack.green = 1.0f; snack.blue = 0.0f;
+
+  for(int s=0; s<NO_OF_SPECIES; s++)
+    glGenBuffers(1, &meshes[s].instanceBuffer);
+}
+
+// a fresh buffer each frame (the driver can keep drawing from last
+// frame's while this one is written), left bound
+void AgentRenderer::reserveInstances(SPECIESMESH &mesh, int count)
+{
+  if (count > mesh.capacity)
+    mesh.capacity = count * 2;		// room to grow without reallocating every frame
+
+  glBindBuffer(GL_ARRAY_BUFFER, mesh.instanceBuffer);
+  glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)mesh.capacity * 4 * sizeof(GLfloat), NULL, GL_STREAM_DRAW);
+}
+
+// one x, y, z, heading per agent
+void AgentRenderer::uploadInstances(SPECIESMESH &mesh, Agent **agents, int count)
+{
+  reserveInstances(mesh, count);
+  GLfloat *v = (GLfloat *)glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
+  for(int i=0; i<count; i++)
+  {
+    Vector3f pos = agents[i]->getRenderPosition();
+    *v++ = pos.x; *v++ = pos.y; *v++ = pos.z;
+    *v++ = agents[i]->getRenderHeading();
+  }
+  glUnmapBuffer(GL_ARRAY_BUFFER);
+}
+
+void AgentRenderer::uploadInstances(SPECIESMESH &mesh, const AGENTINSTANCE *instances, int count)
+{
+  reserveInstances(mesh, count);
+  glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)count * sizeof(AGENTINSTANCE), instances);
+}
+
+// the instances of the agents and the shapes, ready to draw from
+void AgentRenderer::bindInstances(SPECIESMESH &mesh)
+{
+  glUseProgram(program);
+  glUniform3f(colourLocation, mesh.red, mesh.green, mesh.blue);
+
+  // one x, y, z, heading per instance
+  glBindBuffer(GL_ARRAY_BUFFER, mesh.instanceBuffer);
+  glEnableVertexAttribArray(ATTRIB_INSTANCE);
+  glVertexAttribPointer(ATTRIB_INSTANCE, 4, GL_FLOAT, GL_FALSE, 0, (const GLvoid *)0);
+  glVertexAttribDivisor(ATTRIB_INSTANCE, 1);
+
+  // the shape: x, y, z per vertex, the same for every instance
+  glBindBuffer(GL_ARRAY_BUFFER, meshBuffer);
+  glEnableVertexAttribArray(ATTRIB_VERTEX);
+  glVertexAttribPointer(ATTRIB_VERTEX, 3, GL_FLOAT, GL_FALSE, 0, (const GLvoid *)0);
+}
+
+void AgentRenderer::unbindInstances()
+{
+  glVertexAttribDivisor(ATTRIB_INSTANCE, 0);
+  glDisableVertexAttribArray(ATTRIB_INSTANCE);
+  glDisableVertexAttribArray(ATTRIB_VERTEX);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glUseProgram(0);
+}
+
+void AgentRenderer::drawShapes(SPECIESMESH &mesh, int count)
+{
+  bindInstances(mesh);
+
+  glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+  glDrawArraysInstanced(GL_TRIANGLES, mesh.firstTriangleVertex, mesh.noOfTriangleVertices, count);
+
+  if (mesh.noOfLineVertices > 0)
+  {
+    glLineWidth(0.5f);
+    glDrawArraysInstanced(GL_LINES, mesh.firstLineVertex, mesh.noOfLineVertices, count);
+  }
+
+  unbindInstances();
+}
+
+void AgentRenderer::drawTips(SPECIESMESH &mesh, int count)
+{
+  bindInstances(mesh);
+
+  glPointSize(2.0f);
+  glDrawArraysInstanced(GL_POINTS, mesh.pointVertex, 1, count);
+  glPointSize(1.0f);
+
+  unbindInstances();
+}
+
+void AgentRenderer::draw(SpeciesType species, Agent **agents, int count)
+{
+  if (!ready || count <= 0) return;
+
+  uploadInstances(meshes[species], agents, count);
+  drawShapes(meshes[species], count);
+}
+
+void AgentRenderer::drawPoints(SpeciesType species, Agent **agents, int count)
+{
+  if (!ready || count <= 0) return;
+
+  uploadInstances(meshes[species], agents, count);
+  drawTips(meshes[species], count);
+}
+
+void AgentRenderer::draw(SpeciesType species, const AGENTINSTANCE *instances, int count)
+{
+  if (!ready || count <= 0) return;
+
+  uploadInstances(meshes[species], instances, count);
+  drawShapes(meshes[species], count);
+}
+
+void AgentRenderer::drawPoints(SpeciesType species, const AGENTINSTANCE *instances, int count)
+{
+  if (!ready || count <= 0) return;
+
+  uploadInstances(meshes[species], instances, count);
+  drawTips(meshes[species], count);
+}
+
+AgentRenderer::~AgentRenderer()
+{
+  for(int s=0; s<NO_OF_SPECIES; s++)
+    if (meshes[s].instanceBuffer != 0) glDeleteBuffers(1, &meshes[s].instanceBuffer);
+
+  if (meshBuffer != 0) glDeleteBuffers(1, &meshBuffer);
+  if (program != 0) glDeleteProgram(program);
+}
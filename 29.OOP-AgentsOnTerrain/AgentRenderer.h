@@ -0,0 +1,97 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ Instanced Agent Renderer
+//
+//	Agent::render() pushes a matrix, builds a translation and a
+//	rotation matrix, multiplies both in and sends the shape one
+//	vertex at a time, for every agent in every frame. That is
+//	about 20 OpenGL calls per agent.
+//
+//	AgentRenderer uploads the shape of each species (the triangles
+//	and lines of Predator/Prey/Snack::DrawObject) once. Each frame
+//	it writes one instance per agent (x, y, z and heading) into
+//	an instance buffer of the species and draws all agents of the
+//	species with one glDrawArraysInstanced() call (plus one for
+//	the lines of predators and preys). A small shader turns each
+//	instance into the transform render() built with matPos and
+//	matRot. The number of OpenGL calls per frame no longer grows
+//	with the number of agents. The shapes are drawn in the flat
+//	colour of their species, at fScale 1 (every agent's scale).
+//
+//	Far from the camera an agent is a few pixels, drawPoints() draws
+//	each as one point (the tip of its shape) instead of its shape.
+//
+//	Both also take the instances ready made (AGENTINSTANCE), for a
+//	thread that draws from a WorldSnapshot and has no agents to read.
+//
+//	Needs OpenGL 3.3 (or 3.1 and ARB_instanced_arrays) with a
+//	compatibility context. If the shader cannot be built, isReady()
+//	stays false and World draws agent by agent as before.
+//
+//	##########################################################
+
+#ifndef AGENTRENDERER_H
+#define AGENTRENDERER_H
+
+#include "OGLUtil.h"
+#include "Category.h"
+#include "Agent.h"
+
+// one agent as the shader sees it
+struct AGENTINSTANCE
+{
+	float x, y, z, heading;		// heading in degrees
+};
+
+// where the shape of a species is in the mesh buffer, and its instances
+struct SPECIESMESH
+{
+	int firstTriangleVertex, noOfTriangleVertices;
+	int firstLineVertex, noOfLineVertices;		// 0 lines for snacks
+	int pointVertex;							// the tip, for agents far away
+	float red, green, blue;
+
+	GLuint instanceBuffer;		// 4 floats per agent: x, y, z, heading (degrees)
+	int capacity;							// agents the instance buffer holds
+};
+
+/****************************** PROTOTYPES ******************************/
+class AgentRenderer
+{
+private:
+	bool ready;
+	GLuint program;
+	GLint colourLocation;
+	GLuint meshBuffer;				// the shapes of all species, xyz per vertex
+	SPECIESMESH meshes[NO_OF_SPECIES];
+
+	bool buildProgram();
+	void buildMeshes();
+	void reserveInstances(SPECIESMESH &mesh, int count);
+	void uploadInstances(SPECIESMESH &mesh, Agent **agents, int count);
+	void uploadInstances(SPECIESMESH &mesh, const AGENTINSTANCE *instances, int count);
+	void bindInstances(SPECIESMESH &mesh);
+	void unbindInstances();
+	void drawShapes(SPECIESMESH &mesh, int count);
+	void drawTips(SPECIESMESH &mesh, int count);
+
+public:
+	// needs a current OpenGL context
+	AgentRenderer();
+	~AgentRenderer();
+
+	bool isReady() { return ready; }
+
+	// draw agents[0..count), all of the given species
+	void draw(SpeciesType species, Agent **agents, int count);
+	// the same, one point per agent
+	void drawPoints(SpeciesType species, Agent **agents, int count);
+
+	// the same from instances already worked out
+	void draw(SpeciesType species, const AGENTINSTANCE *instances, int count);
+	void drawPoints(SpeciesType species, const AGENTINSTANCE *instances, int count);
+};
+
+#endif
@@ -0,0 +1,129 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ Background Writer (records written off the simulation thread)
+//
+//	Recorders (TrajectoryWriter, FrameWriter) fill preallocated
+//	records on the simulation thread and must not wait on the disk.
+//	A BackgroundWriter owns the thread that writes them: a filled
+//	record goes to it through a lock-free SpscRing, and comes back
+//	through a second ring once it is written, so nothing is allocated
+//	during a run. acquire() only waits when the disk is slower than
+//	the records coming in (every such wait is counted).
+//
+//	The writing thread sleeps for a moment whenever there is nothing
+//	to write, the simulation never signals it. stop() writes what is
+//	still queued before the thread ends.
+//
+//	##########################################################
+
+#ifndef BACKGROUNDWRITER_H
+#define BACKGROUNDWRITER_H
+
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include "SpscRing.h"
+
+using namespace std;
+
+/****************************** PROTOTYPES ******************************/
+template <class T>
+class BackgroundWriter
+{
+private:
+	SpscRing<T*> filled;						// simulation -> writer
+	SpscRing<T*> empty;							// writer -> simulation
+
+	function<void(T*)> write;				// called on the writing thread
+	thread writer;
+	atomic<bool> stopping;
+	bool running;
+
+	long stalls;										// acquire() calls that waited
+
+	void writerLoop()
+	{
+		T *record;
+
+		while (true)
+		{
+			// read before popping: once stopping is seen, every record
+			// submitted before stop() was called is visible to pop()
+			bool last = stopping.load();
+
+			if (filled.pop(record))
+			{
+				write(record);
+				empty.push(record);
+				continue;
+			}
+
+			// nothing queued: finish if asked to (the ring is drained by now),
+			// otherwise check again shortly, the simulation never waits on us
+			if (last) break;
+			this_thread::sleep_for(chrono::microseconds(500));
+		}
+	}
+
+public:
+	// the records[0..count) all start free
+	BackgroundWriter(T *records, int count): filled(count), empty(count)
+	{
+		for(int r = 0; r < count; r++)
+			empty.push(&records[r]);
+
+		stopping.store(false);
+		running = false;
+		stalls = 0;
+	}
+
+	~BackgroundWriter()
+	{
+		stop();
+	}
+
+	// _write(record) is called on the writing thread for every record submitted
+	void start(function<void(T*)> _write)
+	{
+		write = _write;
+		running = true;
+		writer = thread(&BackgroundWriter::writerLoop, this);
+	}
+
+	// a free record, waits for the writing thread to give one back if
+	// it has fallen behind
+	T *acquire()
+	{
+		T *record;
+		if (!empty.pop(record))
+		{
+			stalls++;
+			while (!empty.pop(record))
+				this_thread::yield();
+		}
+		return record;
+	}
+
+	// to be written (cannot fail, there are only count records)
+	void submit(T *record) { filled.push(record); }
+
+	// an acquired record that is not to be written after all
+	void release(T *record) { empty.push(record); }
+
+	// write what is still queued, then end the thread
+	void stop()
+	{
+		if (!running) return;
+
+		stopping.store(true);
+		writer.join();
+		running = false;
+	}
+
+	long getStalls() { return stalls; }
+};
+
+#endif
@@ -0,0 +1,634 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ Benchmark Application (no window is opened)
+//
+//  Times the building blocks of the simulation at population
+//  sizes far beyond what main.cpp renders, so that the effect of
+//  each optimisation can be measured on its own
+//
+//  seek    : brute-force seek() against the SpatialHash seek()
+//  terrain : height lookups on terrains from 4x4 to 4096x4096 quads,
+//            getHeight() against sampleHeight() and sampleHeights()
+//  deform  : a small edit (deform() of radius 5 quads) and refresh(),
+//            against recalculating every normal and plane
+//  dispatch: a tick of agents[i]->update() over species mixed in the
+//            array, against the same agents sorted by species and
+//            updated through their own (final) types
+//  math    : Matrix4x4 and Vector3f as they were (arguments by value,
+//            a new Vector3f per transform) against as they are now
+//
+//  ----------------------------------------------------------
+//  How to compile:
+//  g++ -O2 -I/usr/include/ Benchmark.cpp SimpleTerrain.cpp Agent.cpp Predator.cpp Prey.cpp Snack.cpp Grid.cpp SpatialHash.cpp Population.cpp Profiler.cpp -o benchmark -L/usr/lib -lGL -lGLU
+//
+//  How to run:
+//  ./benchmark          (runs every benchmark)
+//  ./benchmark seek     (runs only the named benchmark)
+//  ./benchmark terrain
+//  ./benchmark deform
+//  ./benchmark dispatch
+//  ./benchmark math
+//	##########################################################
+
+#include <iostream>
+#include <string>
+#include "OGLUtil.h"
+#include "Grid.h"
+#include "Agent.h"
+#include "Predator.h"
+#include "Prey.h"
+#include "Snack.h"
+#include "SpatialHash.h"
+#include "SimpleTerrain.h"
+#include "Timing.h"
+
+using namespace std;
+
+/****************************** PROTOTYPES ******************************/
+void escape(float value);
+void benchmarkSeek();
+void benchmarkTerrain();
+void benchmarkDeform();
+void benchmarkDispatch();
+void benchmarkMath();
+
+/****************************** MAIN METHOD ******************************/
+int main(int argc, char**argv)
+{
+    string which = (argc > 1) ? argv[1] : "all";
+
+    if (which == "all" || which == "seek") benchmarkSeek();
+    if (which == "all" || which == "terrain") benchmarkTerrain();
+    if (which == "all" || which == "deform") benchmarkDeform();
+    if (which == "all" || which == "dispatch") benchmarkDispatch();
+    if (which == "all" || which == "math") benchmarkMath();
+
+    return 0;
+}
+
+// the compiler must assume value is read, so the loops adding it up
+// are not optimised away
+void escape(float value)
+{
+    asm volatile("" : : "g"(value) : "memory");
+}
+
+/****************************** SEEK ******************************/
+// Half the population are predators seeking the other half (prey).
+// The world grows with the population so the density stays at one
+// agent per 10x10 units, i.e. roughly a dozen agents within the
+// seek distance of 20, as a real landscape would.
+void benchmarkSeek()
+{
+    cout<<"*********************** Benchmark: seek ***********************"<<endl;
+    cout<<"agents\tbrute ns/seek\thash ns/seek\tbrute ms/tick\thash ms/tick\tspeedup"<<endl;
+
+    int sizes[] = {64, 256, 1024, 4096, 16384, 65536, 100000};
+    int noOfSizes = sizeof(sizes)/sizeof(sizes[0]);
+
+    for(int s = 0; s < noOfSizes; s++)
+    {
+        int agentNo = sizes[s];
+        float side = sqrt((float)agentNo) * 10.0f;
+
+        silence(true);
+        Grid *grid = new Grid(side, side, 10.0f);
+        SpatialHash *spatialHash = new SpatialHash(grid, 20.0f, agentNo);
+
+        Agent **agents = new Agent*[agentNo];
+        for(int i = 0; i < agentNo; i++)
+        {
+            float x = grid->getLeft() + side * Random::uniform(1, i, 0, STREAM_PLACE_X);
+            float z = grid->getTop() + side * Random::uniform(1, i, 0, STREAM_PLACE_Z);
+
+            if(i % 2 == 0)
+            {
+                agents[i] = new Predator(i, x, 0, z, 0.001f);
+                agents[i]->speciesType = PREDATOR;
+            }
+            else
+            {
+                agents[i] = new Prey(i, x, 0, z, 0.001f);
+                agents[i]->speciesType = PREY;
+            }
+        }
+        for(int i = 0; i < agentNo; i++)
+        {
+            agents[i]->getGrid(grid);
+            agents[i]->getAgents(agents, agentNo);
+        }
+        silence(false);
+
+        // brute force is quadratic, so above 4096 agents only a sample
+        // of seekers is timed and the tick cost is extrapolated
+        int seekers = agentNo < 4096 ? agentNo : 4096;
+
+        // ---------- brute force
+        for(int i = 0; i < agentNo; i++) agents[i]->getSpatialHash(NULL);
+        double t0 = secondsNow();
+        for(int i = 0; i < seekers; i++) agents[i]->seek();
+        double bruteSeek = (secondsNow() - t0) / seekers;
+
+        // ---------- spatial hash (rebuild is part of the tick cost)
+        for(int i = 0; i < agentNo; i++) agents[i]->getSpatialHash(spatialHash);
+        t0 = secondsNow();
+        spatialHash->rebuild(agents, agentNo);
+        double rebuild = secondsNow() - t0;
+
+        t0 = secondsNow();
+        for(int i = 0; i < seekers; i++) agents[i]->seek();
+        double hashSeek = (secondsNow() - t0) / seekers;
+
+        double bruteTick = bruteSeek * agentNo;
+        double hashTick = rebuild + hashSeek * agentNo;
+
+        cout<<agentNo<<"\t"<<bruteSeek*1e9<<"\t\t"<<hashSeek*1e9<<"\t\t"
+            <<bruteTick*1e3<<"\t\t"<<hashTick*1e3<<"\t\t"<<bruteTick/hashTick<<"x"<<endl;
+
+        silence(true);
+        for(int i = 0; i < agentNo; i++)
+        {
+            // the destructors are not virtual, delete through the real type
+            if(i % 2 == 0) delete (Predator*)agents[i];
+            else delete (Prey*)agents[i];
+        }
+        delete[] agents;
+        delete spatialHash;
+        delete grid;
+        silence(false);
+    }
+}
+
+/****************************** TERRAIN ******************************/
+// The terrain always covers 1000x1000 units, the number of quads
+// goes up so each quad gets smaller. "scattered" looks up heights
+// at random positions (agents spread over the whole landscape),
+// "walk" moves a little between lookups (one agent crossing it).
+// The last two columns are the precomputed planes on the scattered
+// positions, one call per agent and one call for all of them.
+void benchmarkTerrain()
+{
+    cout<<"*********************** Benchmark: terrain ***********************"<<endl;
+    cout<<"quads\t\tbuild s\t\tscattered ns/lookup\twalk ns/lookup\tsample ns/lookup\tbatch ns/lookup"<<endl;
+
+    int sizes[] = {4, 64, 256, 1024, 4096};
+    int noOfSizes = sizeof(sizes)/sizeof(sizes[0]);
+    int lookups = 1000000;
+
+    for(int s = 0; s < noOfSizes; s++)
+    {
+        int n = sizes[s];
+        float side = 1000.0f;
+
+        silence(true);
+        double t0 = secondsNow();
+        SimpleTerrain *terrain = new SimpleTerrain(n, n, 1.0f, side / n);
+        double build = secondsNow() - t0;
+        silence(false);
+
+        CELLINFO bounds = terrain->getBoundary();
+        float sum = 0;
+
+        // ---------- scattered
+        t0 = secondsNow();
+        for(int i = 0; i < lookups; i++)
+        {
+            Vector3f pos(bounds.left + side * Random::uniform(1, i, 0, STREAM_PLACE_X), 0,
+                         bounds.top + side * Random::uniform(1, i, 0, STREAM_PLACE_Z));
+            sum += terrain->getHeight(pos);
+        }
+        double scattered = (secondsNow() - t0) / lookups;
+
+        // ---------- walk (diagonal steps of a tenth of a unit)
+        t0 = secondsNow();
+        for(int i = 0; i < lookups; i++)
+        {
+            float d = (i % 9990) * 0.1f + 1.0f;
+            Vector3f pos(bounds.left + d, 0, bounds.top + d);
+            sum += terrain->getHeight(pos);
+        }
+        double walk = (secondsNow() - t0) / lookups;
+
+        // ---------- precomputed planes, positions generated up front
+        float *xs = new float[lookups];
+        float *zs = new float[lookups];
+        float *heights = new float[lookups];
+        for(int i = 0; i < lookups; i++)
+        {
+            xs[i] = bounds.left + side * Random::uniform(1, i, 0, STREAM_PLACE_X);
+            zs[i] = bounds.top + side * Random::uniform(1, i, 0, STREAM_PLACE_Z);
+        }
+
+        t0 = secondsNow();
+        for(int i = 0; i < lookups; i++)
+            sum += terrain->sampleHeight(xs[i], zs[i]);
+        double sample = (secondsNow() - t0) / lookups;
+
+        t0 = secondsNow();
+        terrain->sampleHeights(xs, zs, heights, lookups);
+        double batch = (secondsNow() - t0) / lookups;
+        sum += heights[lookups-1];
+
+        delete[] xs;
+        delete[] zs;
+        delete[] heights;
+
+        // subtract the cost of generating the positions
+        t0 = secondsNow();
+        for(int i = 0; i < lookups; i++)
+            sum += Random::uniform(1, i, 0, STREAM_PLACE_X) + Random::uniform(1, i, 0, STREAM_PLACE_Z);
+        scattered -= (secondsNow() - t0) / lookups;
+
+        cout<<n<<"x"<<n<<"\t"<<(n < 1000 ? "\t" : "")<<build<<"\t\t"<<scattered*1e9<<"\t\t\t"<<walk*1e9
+            <<"\t\t"<<sample*1e9<<"\t\t\t"<<batch*1e9<<endl;
+
+        // keep the lookups from being optimised away
+        escape(sum);
+
+        silence(true);
+        delete terrain;
+        silence(false);
+    }
+}
+
+/****************************** DEFORM ******************************/
+// Agents dig into the terrain at random places, one edit per tick.
+// After each edit refresh() recalculates the tiles it touched, the
+// alternative is calculateNormals() and calculatePlanes() over the
+// whole terrain. The last column is the largest difference between
+// the refreshed normals and planes and a full recalculation.
+void benchmarkDeform()
+{
+    cout<<"*********************** Benchmark: deform ***********************"<<endl;
+    cout<<"quads\t\tedit+refresh us\tfull recalc ms\tspeedup\t\tmax error"<<endl;
+
+    int sizes[] = {64, 256, 1024, 4096};
+    int noOfSizes = sizeof(sizes)/sizeof(sizes[0]);
+    int edits = 1000;
+
+    for(int s = 0; s < noOfSizes; s++)
+    {
+        int n = sizes[s];
+        float side = 1000.0f;
+        float quad = side / n;
+
+        silence(true);
+        SimpleTerrain *terrain = new SimpleTerrain(n, n, 1.0f, quad);
+        silence(false);
+
+        CELLINFO bounds = terrain->getBoundary();
+
+        double t0 = secondsNow();
+        for(int i = 0; i < edits; i++)
+        {
+            float x = bounds.left + side * Random::uniform(1, i, 0, STREAM_PLACE_X);
+            float z = bounds.top + side * Random::uniform(1, i, 0, STREAM_PLACE_Z);
+            terrain->deform(x, z, 5.0f * quad, -0.5f);
+            terrain->refresh();
+        }
+        double edit = (secondsNow() - t0) / edits;
+
+        // keep what refresh() made to compare against
+        int vertices = (n+1) * (n+1);
+        Vector3f *normals = new Vector3f[vertices];
+        float *heights = new float[vertices];
+        for(int x = 0; x <= n; x++)
+            for(int z = 0; z <= n; z++)
+            {
+                normals[x*(n+1)+z] = terrain->normal(x, z);
+                heights[x*(n+1)+z] = terrain->sampleHeight(bounds.left + (x + 0.3f) * quad, bounds.top + (z + 0.6f) * quad);
+            }
+
+        silence(true);
+        int repeats = n <= 1024 ? 5 : 1;
+        t0 = secondsNow();
+        for(int r = 0; r < repeats; r++)
+        {
+            terrain->calculateNormals(NORMAL_FLAT);
+            terrain->calculatePlanes();
+        }
+        double full = (secondsNow() - t0) / repeats;
+        silence(false);
+
+        float error = 0.0f;
+        for(int x = 0; x <= n; x++)
+            for(int z = 0; z <= n; z++)
+            {
+                Vector3f d = terrain->normal(x, z) - normals[x*(n+1)+z];
+                float h = terrain->sampleHeight(bounds.left + (x + 0.3f) * quad, bounds.top + (z + 0.6f) * quad) - heights[x*(n+1)+z];
+                error = fmax(error, fmax(fabs(h), fmax(fabs(d.x), fmax(fabs(d.y), fabs(d.z)))));
+            }
+
+        cout<<n<<"x"<<n<<"\t"<<(n < 1000 ? "\t" : "")<<edit*1e6<<"\t\t"<<full*1e3<<"\t\t"<<full/edit<<"x\t\t"<<error<<endl;
+
+        delete[] normals;
+        delete[] heights;
+
+        silence(true);
+        delete terrain;
+        silence(false);
+    }
+}
+
+/****************************** DISPATCH ******************************/
+// A third each of predators, preys and snacks at the density of the
+// seek benchmark. "mixed" has the species taking turns in the array
+// and calls the virtual update() of each, "sorted" is the same loop
+// with the array ordered by species (the order World keeps), "typed"
+// loops over each species' own array the way World::updateRange()
+// does. The three run one after the other on the same agents.
+template <class T>
+static void updateTyped(T **array, int count)
+{
+    for(int i = 0; i < count; i++)
+        array[i]->update();
+}
+
+void benchmarkDispatch()
+{
+    cout<<"*********************** Benchmark: dispatch ***********************"<<endl;
+    cout<<"agents\tmixed ns/agent\tsorted ns/agent\ttyped ns/agent\tspeedup"<<endl;
+
+    int sizes[] = {3000, 30000, 300000};
+    int noOfSizes = sizeof(sizes)/sizeof(sizes[0]);
+    int ticks = 20;
+
+    for(int s = 0; s < noOfSizes; s++)
+    {
+        int agentNo = sizes[s];
+        int perSpecies = agentNo / 3;
+        float side = sqrt((float)agentNo) * 10.0f;
+        long tick = 0;
+
+        silence(true);
+        Grid *grid = new Grid(side, side, 10.0f);
+        SimpleTerrain *terrain = new SimpleTerrain(64, 64, 1.0f, side / 64);
+        SpatialHash *spatialHash = new SpatialHash(grid, 20.0f, agentNo);
+
+        Predator **predators = new Predator*[perSpecies];
+        Prey **preys = new Prey*[perSpecies];
+        Snack **snacks = new Snack*[perSpecies];
+        Agent **mixed = new Agent*[agentNo];
+        Agent **sorted = new Agent*[agentNo];
+
+        for(int k = 0; k < perSpecies; k++)
+        {
+            for(int t = 0; t < 3; t++)
+            {
+                int i = 3*k + t;
+                float x = grid->getLeft() + side * Random::uniform(1, i, 0, STREAM_PLACE_X);
+                float z = grid->getTop() + side * Random::uniform(1, i, 0, STREAM_PLACE_Z);
+
+                if (t == 0) mixed[i] = predators[k] = new Predator(i, x, 0, z, 0.001f);
+                else if (t == 1) mixed[i] = preys[k] = new Prey(i, x, 0, z, 0.001f);
+                else mixed[i] = snacks[k] = new Snack(i, x, 0, z, 0.0f);
+                mixed[i]->speciesType = (SpeciesType)t;
+            }
+            sorted[k] = predators[k];
+            sorted[perSpecies + k] = preys[k];
+            sorted[2*perSpecies + k] = snacks[k];
+        }
+
+        // the agents seek each other in the sorted array, as in World
+        for(int i = 0; i < agentNo; i++)
+        {
+            sorted[i]->getGrid(grid);
+            sorted[i]->getAgents(sorted, agentNo);
+            sorted[i]->getTerrain(terrain);
+            sorted[i]->getSpatialHash(spatialHash);
+            sorted[i]->getRandom(1, &tick);
+        }
+        spatialHash->rebuild(sorted, agentNo);
+
+        // one tick to settle in (caches, first targets)
+        for(int i = 0; i < agentNo; i++) sorted[i]->update();
+        tick++;
+
+        double times[3];
+        for(int run = 0; run < 3; run++)
+        {
+            double t0 = secondsNow();
+            for(int t = 0; t < ticks; t++, tick++)
+            {
+                if (run == 0)
+                    for(int i = 0; i < agentNo; i++) mixed[i]->update();
+                else if (run == 1)
+                    for(int i = 0; i < agentNo; i++) sorted[i]->update();
+                else
+                {
+                    updateTyped(predators, perSpecies);
+                    updateTyped(preys, perSpecies);
+                    updateTyped(snacks, perSpecies);
+                }
+            }
+            times[run] = (secondsNow() - t0) / ((double)ticks * agentNo);
+        }
+        silence(false);
+
+        cout<<agentNo<<"\t"<<times[0]*1e9<<"\t\t"<<times[1]*1e9<<"\t\t"<<times[2]*1e9
+            <<"\t\t"<<times[0]/times[2]<<"x"<<endl;
+
+        silence(true);
+        for(int k = 0; k < perSpecies; k++)
+        {
+            // the destructors are not virtual, delete through the real type
+            delete predators[k];
+            delete preys[k];
+            delete snacks[k];
+        }
+        delete[] predators;
+        delete[] preys;
+        delete[] snacks;
+        delete[] mixed;
+        delete[] sorted;
+        delete spatialHash;
+        delete terrain;
+        delete grid;
+        silence(false);
+    }
+}
+
+/****************************** MATH ******************************/
+// The old operations are kept here as they were in Matrix4x4.h and
+// Vector3f.h: whole matrices and vectors copied into each call, and
+// the vector transform returning a new Vector3f (deleted here, the
+// callers used to leak it). Both sides are noinline so that each
+// operation is a real call, as it is from another source file.
+// "sse dot" is a 4-wide dot product of two Vector3f for comparison.
+__attribute__((noinline)) static Matrix4x4 oldMultiply(Matrix4x4 A, Matrix4x4 N)
+{
+    Matrix4x4 newM;
+    newM.m11 = A.m11*N.m11 + A.m12*N.m21 + A.m13*N.m31 + A.m14*N.tx;
+    newM.m12 = A.m11*N.m12 + A.m12*N.m22 + A.m13*N.m32 + A.m14*N.ty;
+    newM.m13 = A.m11*N.m13 + A.m12*N.m23 + A.m13*N.m33 + A.m14*N.tz;
+    newM.m14 = A.m11*N.m14 + A.m12*N.m24 + A.m13*N.m34 + A.m14*N.m44;
+    newM.m21 = A.m21*N.m11 + A.m22*N.m21 + A.m23*N.m31 + A.m24*N.tx;
+    newM.m22 = A.m21*N.m12 + A.m22*N.m22 + A.m23*N.m32 + A.m24*N.ty;
+    newM.m23 = A.m21*N.m13 + A.m22*N.m23 + A.m23*N.m33 + A.m24*N.tz;
+    newM.m24 = A.m21*N.m14 + A.m22*N.m24 + A.m23*N.m34 + A.m24*N.m44;
+    newM.m31 = A.m31*N.m11 + A.m32*N.m21 + A.m33*N.m31 + A.m34*N.tx;
+    newM.m32 = A.m31*N.m12 + A.m32*N.m22 + A.m33*N.m32 + A.m34*N.ty;
+    newM.m33 = A.m31*N.m13 + A.m32*N.m23 + A.m33*N.m33 + A.m34*N.tz;
+    newM.m34 = A.m31*N.m14 + A.m32*N.m24 + A.m33*N.m34 + A.m34*N.m44;
+    newM.tx = A.tx*N.m11 + A.ty*N.m21 + A.tz*N.m31 + A.m44*N.tx;
+    newM.ty = A.tx*N.m12 + A.ty*N.m22 + A.tz*N.m32 + A.m44*N.ty;
+    newM.tz = A.tx*N.m13 + A.ty*N.m23 + A.tz*N.m33 + A.m44*N.tz;
+    newM.m44 = A.tx*N.m14 + A.ty*N.m24 + A.tz*N.m34 + A.m44*N.m44;
+    return newM;
+}
+
+__attribute__((noinline)) static Matrix4x4 newMultiply(const Matrix4x4 &A, const Matrix4x4 &N)
+{
+    return A.multiply(N);
+}
+
+__attribute__((noinline)) static Vector3f *oldTransform(const Vector3f v, const Matrix4x4 M)
+{
+    return new Vector3f(v.x*M.m11 + v.y*M.m21 + v.z*M.m31 + M.tx,
+                        v.x*M.m12 + v.y*M.m22 + v.z*M.m32 + M.ty,
+                        v.x*M.m13 + v.y*M.m23 + v.z*M.m33 + M.tz);
+}
+
+__attribute__((noinline)) static Vector3f newTransform(const Vector3f &v, const Matrix4x4 &M)
+{
+    return v * M;
+}
+
+__attribute__((noinline)) static Vector3f oldCrossNormalise(Vector3f a, Vector3f b)
+{
+    Vector3f n(a.y*b.z - a.z*b.y, a.z*b.x - a.x*b.z, a.x*b.y - a.y*b.x);
+    n.normalise();
+    return n;
+}
+
+__attribute__((noinline)) static Vector3f newCrossNormalise(const Vector3f &a, const Vector3f &b)
+{
+    Vector3f n = a.crossProduct(b);
+    n.normalise();
+    return n;
+}
+
+__attribute__((noinline)) static float oldDot(Vector3f a, Vector3f b)
+{
+    return a.x*b.x + a.y*b.y + a.z*b.z;
+}
+
+__attribute__((noinline)) static float newDot(const Vector3f &a, const Vector3f &b)
+{
+    return a.dotProduct(b);
+}
+
+__attribute__((noinline)) static float sseDot(const Vector3f &a, const Vector3f &b)
+{
+    __m128 p = _mm_mul_ps(_mm_setr_ps(a.x, a.y, a.z, 0.0f), _mm_setr_ps(b.x, b.y, b.z, 0.0f));
+    p = _mm_add_ps(p, _mm_movehl_ps(p, p));
+    p = _mm_add_ss(p, _mm_shuffle_ps(p, p, 1));
+    return _mm_cvtss_f32(p);
+}
+
+void benchmarkMath()
+{
+    cout<<"*********************** Benchmark: math ***********************"<<endl;
+    cout<<"operation\t\told ns\t\tnew ns\t\tspeedup\t\tmax difference"<<endl;
+
+    const int n = 1024;
+    const int repeats = 2000;
+    Matrix4x4 *matrices = new Matrix4x4[n];
+    Vector3f *vectors = new Vector3f[n];
+    for(int i = 0; i < n; i++)
+    {
+        matrices[i].rotateY(360.0f * Random::uniform(1, i, 0, STREAM_TURN));
+        matrices[i].translate(Random::uniform(1, i, 0, STREAM_PLACE_X), 0.5f, Random::uniform(1, i, 0, STREAM_PLACE_Z));
+        vectors[i] = Vector3f(Random::uniform(1, i, 1, STREAM_PLACE_X), Random::uniform(1, i, 1, STREAM_PLACE_Z), 1.0f);
+    }
+
+    double t0, oldTime, newTime;
+    float difference, sum = 0.0f;
+    long calls = (long)n * repeats;
+
+    // ---------- matrix times matrix
+    difference = 0.0f;
+    t0 = secondsNow();
+    for(int r = 0; r < repeats; r++)
+        for(int i = 0; i < n; i++) sum += oldMultiply(matrices[i], matrices[(i+1) % n]).tx;
+    oldTime = (secondsNow() - t0) / calls;
+    t0 = secondsNow();
+    for(int r = 0; r < repeats; r++)
+        for(int i = 0; i < n; i++) sum += newMultiply(matrices[i], matrices[(i+1) % n]).tx;
+    newTime = (secondsNow() - t0) / calls;
+    for(int i = 0; i < n; i++)
+    {
+        Matrix4x4 a = oldMultiply(matrices[i], matrices[(i+1) % n]);
+        Matrix4x4 b = newMultiply(matrices[i], matrices[(i+1) % n]);
+        a.fillMatrix();
+        for(int k = 0; k < 16; k++) difference = fmax(difference, fabs(a.matrix[k] - b.matrix[k]));
+    }
+    cout<<"matrix * matrix\t\t"<<oldTime*1e9<<"\t\t"<<newTime*1e9<<"\t\t"<<oldTime/newTime<<"x\t\t"<<difference<<endl;
+
+    // ---------- vector times matrix
+    difference = 0.0f;
+    t0 = secondsNow();
+    for(int r = 0; r < repeats; r++)
+        for(int i = 0; i < n; i++)
+        {
+            Vector3f *v = oldTransform(vectors[i], matrices[i]);
+            sum += v->x;
+            delete v;
+        }
+    oldTime = (secondsNow() - t0) / calls;
+    t0 = secondsNow();
+    for(int r = 0; r < repeats; r++)
+        for(int i = 0; i < n; i++) sum += newTransform(vectors[i], matrices[i]).x;
+    newTime = (secondsNow() - t0) / calls;
+    for(int i = 0; i < n; i++)
+    {
+        Vector3f *a = oldTransform(vectors[i], matrices[i]);
+        Vector3f b = newTransform(vectors[i], matrices[i]);
+        difference = fmax(difference, Vector3f::distance(*a, b));
+        delete a;
+    }
+    cout<<"vector * matrix\t\t"<<oldTime*1e9<<"\t\t"<<newTime*1e9<<"\t\t"<<oldTime/newTime<<"x\t\t"<<difference<<endl;
+
+    // ---------- cross product and normalise (a terrain normal)
+    difference = 0.0f;
+    t0 = secondsNow();
+    for(int r = 0; r < repeats; r++)
+        for(int i = 0; i < n; i++) sum += oldCrossNormalise(vectors[i], vectors[(i+1) % n]).y;
+    oldTime = (secondsNow() - t0) / calls;
+    t0 = secondsNow();
+    for(int r = 0; r < repeats; r++)
+        for(int i = 0; i < n; i++) sum += newCrossNormalise(vectors[i], vectors[(i+1) % n]).y;
+    newTime = (secondsNow() - t0) / calls;
+    for(int i = 0; i < n; i++)
+        difference = fmax(difference, Vector3f::distance(oldCrossNormalise(vectors[i], vectors[(i+1) % n]),
+                                                         newCrossNormalise(vectors[i], vectors[(i+1) % n])));
+    cout<<"cross + normalise\t"<<oldTime*1e9<<"\t\t"<<newTime*1e9<<"\t\t"<<oldTime/newTime<<"x\t\t"<<difference<<endl;
+
+    // ---------- dot product, and a 4-wide one
+    difference = 0.0f;
+    t0 = secondsNow();
+    for(int r = 0; r < repeats; r++)
+        for(int i = 0; i < n; i++) sum += oldDot(vectors[i], vectors[(i+1) % n]);
+    oldTime = (secondsNow() - t0) / calls;
+    t0 = secondsNow();
+    for(int r = 0; r < repeats; r++)
+        for(int i = 0; i < n; i++) sum += newDot(vectors[i], vectors[(i+1) % n]);
+    newTime = (secondsNow() - t0) / calls;
+    for(int i = 0; i < n; i++)
+        difference = fmax(difference, fabs(oldDot(vectors[i], vectors[(i+1) % n]) - newDot(vectors[i], vectors[(i+1) % n])));
+    cout<<"dot\t\t\t"<<oldTime*1e9<<"\t\t"<<newTime*1e9<<"\t\t"<<oldTime/newTime<<"x\t\t"<<difference<<endl;
+
+    t0 = secondsNow();
+    for(int r = 0; r < repeats; r++)
+        for(int i = 0; i < n; i++) sum += sseDot(vectors[i], vectors[(i+1) % n]);
+    newTime = (secondsNow() - t0) / calls;
+    cout<<"sse dot\t\t\t"<<oldTime*1e9<<"\t\t"<<newTime*1e9<<"\t\t"<<oldTime/newTime<<"x"<<endl;
+
+    // keep the results from being optimised away
+    escape(sum);
+
+    delete[] matrices;
+    delete[] vectors;
+}
@@ -43,6 +43,12 @@ Camera::Camera()
 	// angles
 	rotAngle = 0.1f;
 	pitchAngle = 1.0f;
+
+	// the perspective of main.cpp until setPerspective()
+	fovy = 45.0f;
+	aspect = 1.0f;
+	zNear = 0.1f;
+	zFar = 5000.0f;
 }
 
 
@@ -76,6 +82,11 @@ Camera::Camera(Vector3f initialPos, Vector3f initialTarget, float _speed, float
 
 	rotAngle = _rotAngle;	// assign the angle rotate speed
 	pitchAngle = 1.0f;		// assign pitch angle
+
+	fovy = 45.0f;
+	aspect = 1.0f;
+	zNear = 0.1f;
+	zFar = 5000.0f;
 }
 
 Camera::~Camera()
@@ -130,6 +141,24 @@ void Camera::update()
 	//cout<<"Camera Origin:"<<x<< " "<<y<<" "<<" "<<z<<" Target:"<<tx<<" "<<ty<<" "<<tz<<endl;
 }
 
+// gluPerspective on the current (projection) matrix, remembered for getFrustum()
+void Camera::setPerspective(float _fovy, float _aspect, float _zNear, float _zFar)
+{
+	fovy = _fovy;
+	aspect = _aspect;
+	zNear = _zNear;
+	zFar = _zFar;
+
+	gluPerspective(fovy, aspect, zNear, zFar);
+}
+
+Frustum Camera::getFrustum()
+{
+	Frustum frustum;
+	frustum.set(Vector3f(x, y, z), Vector3f(tx, ty, tz), Vector3f(0.0f, 1.0f, 0.0f), fovy, aspect, zNear, zFar);
+	return frustum;
+}
+
 float Camera::DEG2RAD(float angle)
 {
 	return angle * (PI/180.0f);
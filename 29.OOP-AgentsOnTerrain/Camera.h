@@ -15,6 +15,7 @@
 #define CAMERA_H
 
 #include "OGLUtil.h"
+#include "Frustum.h"
 
 /****************************** PROTOTYPES ******************************/
 class Camera
@@ -38,6 +39,9 @@ public:
 	float x, y, z;				// camera position
 	float cosYaw, sinYaw, sinPitch, cosPitch;
 
+	// the perspective of the projection matrix (see setPerspective)
+	float fovy, aspect, zNear, zFar;
+
 	Camera();
 	Camera(Vector3f initialPos, Vector3f initialTarget, float _speed, float _rotAngle, float _eyeHeight);
 	~Camera();
@@ -46,6 +50,8 @@ public:
 	void print();
 	float DEG2RAD(float angle);
 	void update();
+	void setPerspective(float _fovy, float _aspect, float _zNear, float _zFar);
+	Frustum getFrustum();		// what gluLookAt from here and the perspective see
 	void setEyeHeight(float value);
 	void setMaxSpeed(float value);
 	void moveForward();
@@ -9,10 +9,14 @@
 //
 //	##########################################################
 
+#ifndef CATEGORY_H
+#define CATEGORY_H
+
 // struct Category
 // {
 	enum ObjectType { AGENT, EMITTER };
 	enum SpeciesType { PREDATOR, PREY, SNACK };
+	const int NO_OF_SPECIES = SNACK + 1;	// used for sizing per-species tables
 // };
 
 
@@ -24,3 +28,5 @@
 // 		cout<<endl<<"type id of object: "<<typeid(this).name()<<endl;  // this should always print Base as its not dereferenced
 // 		cout<<endl<<"type id of dereferenced object (*this): "<<typeid(*this).name()<<endl;  // Why this is also printing Base?
 // }
+
+#endif
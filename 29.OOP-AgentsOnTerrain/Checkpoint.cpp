@@ -0,0 +1,298 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ Checkpoint (save and restore a running World)
+//
+//	See Checkpoint.h for the rationale and the file layout
+//
+//	##########################################################
+
+#include <iostream>
+#include <string>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "Checkpoint.h"
+
+using namespace std;
+
+static const char CHECKPOINT_MAGIC[8] = "ABMCKPT";
+
+// bytes per element of each array
+static const int elementSize[CKPT_ARRAYS] =
+{
+	sizeof(float), sizeof(float), sizeof(float),
+	sizeof(float), sizeof(float), sizeof(float),
+	sizeof(int32_t), sizeof(uint8_t), sizeof(uint32_t), sizeof(float)
+};
+
+static uint64_t alignUp(uint64_t n)
+{
+	return (n + 63) & ~(uint64_t)63;
+}
+
+// write an array at its offset, padding the gap since the last one with zeros
+static bool writeArray(FILE *file, uint64_t &written, uint64_t offset, const void *data, uint64_t bytes)
+{
+	static const char zeros[64] = {0};
+
+	if (fwrite(zeros, 1, offset - written, file) != offset - written) return false;
+	if (bytes > 0 && fwrite(data, 1, bytes, file) != bytes) return false;
+
+	written = offset + bytes;
+	return true;
+}
+
+// the floats a terrain of width x height quads keeps in its tiled
+// layout (see SimpleTerrain::allocate), 0 if the size makes no sense
+static uint64_t tiledPoints(int32_t width, int32_t height)
+{
+	if (width < 1 || height < 1 || width > (1 << 20) || height > (1 << 20)) return 0;
+
+	uint64_t tilesX = ((uint64_t)width + TERRAIN_TILE) / TERRAIN_TILE;
+	uint64_t tilesZ = ((uint64_t)height + TERRAIN_TILE) / TERRAIN_TILE;
+	return tilesX * tilesZ * TERRAIN_TILE * TERRAIN_TILE;
+}
+
+// offsets of the arrays and the file size from the counts in the header
+void Checkpoint::layout(CHECKPOINTHEADER &header)
+{
+	uint64_t agentNo = (uint64_t)header.noOfPredators + header.noOfPreys + header.noOfSnacks;
+	uint64_t position = alignUp(sizeof(CHECKPOINTHEADER));
+
+	for(int a = 0; a < CKPT_ARRAYS; a++)
+	{
+		uint64_t count = (a == CKPT_HEIGHTS) ? header.terrainPoints : agentNo;
+		header.offset[a] = position;
+		position = alignUp(position + count * elementSize[a]);
+	}
+
+	header.fileSize = position;
+}
+
+bool Checkpoint::save(World *world, const char *filename)
+{
+	int n = world->agentNo;
+	SimpleTerrain *terrain = world->terrain;
+
+	CHECKPOINTHEADER header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+	header.version = CHECKPOINT_VERSION;
+	header.headerSize = sizeof(CHECKPOINTHEADER);
+	header.tick = world->tick;
+	header.seed = world->seed;
+	header.noOfPredators = world->noOfPredators;
+	header.noOfPreys = world->noOfPreys;
+	header.noOfSnacks = world->noOfSnacks;
+	header.nextId = world->nextId;
+	header.gridWidth = world->grid->getWidth();
+	header.gridHeight = world->grid->getHeight();
+	header.gridSegments = world->grid->getSegments();
+	header.terrainWidth = terrain->dWidth;
+	header.terrainHeight = terrain->dHeight;
+	header.scaleHeight = terrain->scaleHeight;
+	header.terrainScale = terrain->terrainScale;
+	header.terrainTile = TERRAIN_TILE;
+	header.terrainPoints = terrain->noOfPoints;
+	header.seekDistance = world->seekDistance;
+	header.fieldOfView = world->fieldOfView;
+	layout(header);
+
+	// gather the agents' variables one array at a time
+	float *values[CKPT_TARGET];
+	for(int a = 0; a < CKPT_TARGET; a++) values[a] = new float[n];
+	int32_t *targets = new int32_t[n];
+	uint8_t *flags = new uint8_t[n];
+	uint32_t *ids = new uint32_t[n];
+
+	for(int i = 0; i < n; i++)
+	{
+		Agent *agent = world->agents[i];
+		values[CKPT_POS_X][i] = agent->vPos().x;
+		values[CKPT_POS_Y][i] = agent->vPos().y;
+		values[CKPT_POS_Z][i] = agent->vPos().z;
+		values[CKPT_HEADING][i] = agent->fCurrAngle();
+		values[CKPT_ANGULAR_VELOCITY][i] = agent->fAngle();
+		values[CKPT_MOVEMENT][i] = agent->fMovement();
+
+		uint8_t f = 0;
+		if (agent->isForward()) f |= CKPT_FLAG_FORWARD;
+		if (agent->isBackward()) f |= CKPT_FLAG_BACKWARD;
+		if (agent->isLeft()) f |= CKPT_FLAG_LEFT;
+		if (agent->isRight()) f |= CKPT_FLAG_RIGHT;
+		if (agent->isMoving) f |= CKPT_FLAG_MOVING;
+
+		// handles are only valid in this run, the target is saved by index
+		Agent *target = NULL;
+		if (agent->speciesType == PREDATOR) target = world->pools[PREY]->get(((Predator*)agent)->_prey);
+		else if (agent->speciesType == PREY) target = world->pools[SNACK]->get(((Prey*)agent)->_prey);
+		else if (((Snack*)agent)->_isEaten) f |= CKPT_FLAG_EATEN;
+		targets[i] = (target != NULL) ? target->index : -1;
+
+		flags[i] = f;
+		ids[i] = agent->id;
+	}
+
+	// write to a temporary file first, so being stopped halfway through
+	// never leaves a broken checkpoint in place of the last good one
+	string temporary = string(filename) + ".tmp";
+	FILE *file = fopen(temporary.c_str(), "wb");
+	bool ok = (file != NULL);
+
+	uint64_t written = 0;
+	if (ok) ok = writeArray(file, written, 0, &header, sizeof(header));
+	for(int a = 0; a < CKPT_TARGET && ok; a++)
+		ok = writeArray(file, written, header.offset[a], values[a], (uint64_t)n * sizeof(float));
+	if (ok) ok = writeArray(file, written, header.offset[CKPT_TARGET], targets, (uint64_t)n * sizeof(int32_t));
+	if (ok) ok = writeArray(file, written, header.offset[CKPT_FLAGS], flags, (uint64_t)n);
+	if (ok) ok = writeArray(file, written, header.offset[CKPT_ID], ids, (uint64_t)n * sizeof(uint32_t));
+	if (ok) ok = writeArray(file, written, header.offset[CKPT_HEIGHTS], terrain->heightField, header.terrainPoints * sizeof(float));
+	if (ok) ok = writeArray(file, written, header.fileSize, NULL, 0);
+
+	if (file != NULL && fclose(file) != 0) ok = false;
+	if (ok) ok = (rename(temporary.c_str(), filename) == 0);
+
+	for(int a = 0; a < CKPT_TARGET; a++) delete[] values[a];
+	delete[] targets;
+	delete[] flags;
+	delete[] ids;
+
+	if (ok)
+		cout<<">> Checkpoint saved: "<<filename<<" (tick "<<world->tick<<", "<<header.fileSize<<" bytes)"<<endl;
+	else
+	{
+		cout<<">> Checkpoint could not be written: "<<filename<<endl;
+		remove(temporary.c_str());
+	}
+
+	return ok;
+}
+
+World *Checkpoint::restore(const char *filename)
+{
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0)
+	{
+		cout<<">> Checkpoint not found: "<<filename<<endl;
+		return NULL;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(CHECKPOINTHEADER))
+	{
+		cout<<">> Checkpoint is too small: "<<filename<<endl;
+		close(fd);
+		return NULL;
+	}
+
+	void *mapped = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapped == MAP_FAILED)
+	{
+		cout<<">> Checkpoint could not be mapped: "<<filename<<endl;
+		return NULL;
+	}
+
+	// the arrays are read front to back once
+	madvise(mapped, info.st_size, MADV_SEQUENTIAL);
+
+	const char *base = (const char *)mapped;
+	CHECKPOINTHEADER header;
+	memcpy(&header, base, sizeof(header));
+
+	// the offsets are recomputed rather than trusted
+	CHECKPOINTHEADER expected = header;
+	layout(expected);
+
+	const char *problem = NULL;
+	if (memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) != 0) problem = "not a checkpoint";
+	else if (header.version != CHECKPOINT_VERSION) problem = "unsupported version";
+	else if (header.headerSize != sizeof(CHECKPOINTHEADER)) problem = "unexpected header size";
+	else if (header.terrainTile != TERRAIN_TILE) problem = "terrain saved with a different tile size";
+	else if (header.fileSize != (uint64_t)info.st_size || expected.fileSize != header.fileSize) problem = "truncated or damaged";
+	else if (memcmp(header.offset, expected.offset, sizeof(header.offset)) != 0) problem = "damaged array offsets";
+	else if (tiledPoints(header.terrainWidth, header.terrainHeight) != header.terrainPoints) problem = "terrain size mismatch";
+	else if (!(header.seekDistance > 0.0f)) problem = "damaged seek distance";
+	else if ((uint64_t)header.noOfPredators + header.noOfPreys + header.noOfSnacks > 0x7fffffff) problem = "too many agents";
+
+	// every array inside the file, before anything is read out of it
+	uint64_t agentNo = (uint64_t)header.noOfPredators + header.noOfPreys + header.noOfSnacks;
+	for(int a = 0; a < CKPT_ARRAYS && problem == NULL; a++)
+	{
+		uint64_t count = (a == CKPT_HEIGHTS) ? header.terrainPoints : agentNo;
+		if (header.offset[a] > (uint64_t)info.st_size || count * elementSize[a] > (uint64_t)info.st_size - header.offset[a])
+			problem = "array beyond the end of the file";
+	}
+
+	// a predator hunts a prey, a prey a snack and a snack nothing,
+	// agents[] holds the predators first, then the preys, then the snacks
+	const int32_t *targets = (const int32_t *)(base + header.offset[CKPT_TARGET]);
+	int64_t firstPrey = header.noOfPredators, firstSnack = firstPrey + header.noOfPreys;
+	for(int64_t i = 0; i < (int64_t)agentNo && problem == NULL; i++)
+	{
+		int64_t low = (i < firstPrey) ? firstPrey : firstSnack;
+		int64_t high = (i < firstPrey) ? firstSnack : (i < firstSnack) ? (int64_t)agentNo : low;
+		if (targets[i] != -1 && (targets[i] < low || targets[i] >= high)) problem = "damaged targets";
+	}
+
+	if (problem != NULL)
+	{
+		cout<<">> Checkpoint refused ("<<problem<<"): "<<filename<<endl;
+		munmap(mapped, info.st_size);
+		return NULL;
+	}
+
+	cout<<"*********************** Restoring Checkpoint ***********************"<<endl;
+	Grid *grid = new Grid(header.gridWidth, header.gridHeight, header.gridSegments);
+	SimpleTerrain *terrain = new SimpleTerrain(header.terrainWidth, header.terrainHeight,
+		header.scaleHeight, header.terrainScale, (const float *)(base + header.offset[CKPT_HEIGHTS]));
+
+	World *world = new World(grid, terrain, header.noOfPredators, header.noOfPreys, header.noOfSnacks, header.seed);
+	world->tick = header.tick;
+	world->nextId = header.nextId;
+	world->setSenses(header.seekDistance, header.fieldOfView);
+
+	const float *posX = (const float *)(base + header.offset[CKPT_POS_X]);
+	const float *posY = (const float *)(base + header.offset[CKPT_POS_Y]);
+	const float *posZ = (const float *)(base + header.offset[CKPT_POS_Z]);
+	const float *heading = (const float *)(base + header.offset[CKPT_HEADING]);
+	const float *angularVelocity = (const float *)(base + header.offset[CKPT_ANGULAR_VELOCITY]);
+	const float *movement = (const float *)(base + header.offset[CKPT_MOVEMENT]);
+	const uint8_t *flags = (const uint8_t *)(base + header.offset[CKPT_FLAGS]);
+	const uint32_t *ids = (const uint32_t *)(base + header.offset[CKPT_ID]);
+
+	for(int i = 0; i < world->agentNo; i++)
+	{
+		Agent *agent = world->agents[i];
+		agent->vPos() = Vector3f(posX[i], posY[i], posZ[i]);
+		agent->fCurrAngle() = heading[i];
+		agent->fAngle() = angularVelocity[i];
+		agent->fMovement() = movement[i];
+		agent->id = ids[i];		// random numbers depend on it
+
+		uint8_t f = flags[i];
+		agent->isForward() = (f & CKPT_FLAG_FORWARD) != 0;
+		agent->isBackward() = (f & CKPT_FLAG_BACKWARD) != 0;
+		agent->isLeft() = (f & CKPT_FLAG_LEFT) != 0;
+		agent->isRight() = (f & CKPT_FLAG_RIGHT) != 0;
+		agent->isMoving = (f & CKPT_FLAG_MOVING) != 0;
+
+		AgentHandle target = (targets[i] >= 0) ? world->agents[targets[i]]->getHandle() : NO_AGENT;
+		if (agent->speciesType == PREDATOR) ((Predator*)agent)->_prey = target;
+		else if (agent->speciesType == PREY) ((Prey*)agent)->_prey = target;
+		else ((Snack*)agent)->_isEaten = (f & CKPT_FLAG_EATEN) != 0;
+
+		// nothing to draw between until the next tick
+		agent->savePrevious();
+	}
+
+	munmap(mapped, info.st_size);
+
+	cout<<">> Checkpoint restored: "<<filename<<" (tick "<<world->tick<<")"<<endl;
+	return world;
+}
@@ -0,0 +1,100 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ Checkpoint (save and restore a running World)
+//
+//	Long runs get interrupted. A checkpoint holds everything that
+//	the next tick depends on: the Grid parameters, the terrain
+//	heights, how far and how wide the agents seek (World::setSenses),
+//	the state of every agent and the random number state,
+//	which for a counter-based generator is only the seed and the
+//	tick (see Random.h). Restoring a checkpoint and running on gives
+//	the same result as never having stopped.
+//
+//	The file is a fixed header followed by one array per variable
+//	(all agents' x, then all agents' y, ...), each starting on a 64
+//	byte boundary. The arrays are in the same binary form as in
+//	memory, so restore() maps the file with mmap() and copies
+//	straight out of it without parsing anything.
+//
+//	The numbers are written in the byte order of the machine (little
+//	endian on x86 and ARM). The version number changes whenever the
+//	layout does, and older files are refused rather than misread.
+//
+//	##########################################################
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+#include "World.h"
+
+#define CHECKPOINT_VERSION 3
+
+// the arrays that follow the header, in file order
+enum CheckpointArray
+{
+	CKPT_POS_X,						// float, vPos
+	CKPT_POS_Y,
+	CKPT_POS_Z,
+	CKPT_HEADING,					// float, fCurrAngle
+	CKPT_ANGULAR_VELOCITY,	// float, fAngle
+	CKPT_MOVEMENT,				// float, fMovement
+	CKPT_TARGET,					// int32, index of the target of predators and preys (-1 for none)
+	CKPT_FLAGS,						// uint8, CKPT_FLAG_ bits
+	CKPT_ID,							// uint32, getID()
+	CKPT_HEIGHTS,					// float, terrain heightField in its tiled layout
+	CKPT_ARRAYS
+};
+
+// movement flags and _isEaten of an agent packed into one byte
+enum
+{
+	CKPT_FLAG_FORWARD = 1,
+	CKPT_FLAG_BACKWARD = 2,
+	CKPT_FLAG_LEFT = 4,
+	CKPT_FLAG_RIGHT = 8,
+	CKPT_FLAG_MOVING = 16,
+	CKPT_FLAG_EATEN = 32
+};
+
+struct CHECKPOINTHEADER
+{
+	char magic[8];						// "ABMCKPT"
+	uint32_t version;					// CHECKPOINT_VERSION
+	uint32_t headerSize;			// sizeof(CHECKPOINTHEADER) of the writer
+	uint64_t fileSize;				// a truncated file is refused
+	uint64_t tick;						// random number state: tick ...
+	uint32_t seed;						// ... and seed
+	uint32_t noOfPredators, noOfPreys, noOfSnacks;
+	uint32_t nextId;					// id of the next agent born
+
+	float gridWidth, gridHeight, gridSegments;
+
+	int32_t terrainWidth, terrainHeight;
+	float scaleHeight, terrainScale;
+	int32_t terrainTile;			// TERRAIN_TILE the heights were laid out with
+	uint64_t terrainPoints;		// number of floats in CKPT_HEIGHTS
+
+	float seekDistance, fieldOfView;	// World::setSenses()
+
+	uint64_t offset[CKPT_ARRAYS];	// from the start of the file
+};
+
+/****************************** PROTOTYPES ******************************/
+class Checkpoint
+{
+private:
+	static void layout(CHECKPOINTHEADER &header);
+
+public:
+	// write the world to filename, false if the file could not be written
+	static bool save(World *world, const char *filename);
+
+	// a new World as it was saved, NULL if the file is missing or invalid
+	// (batch and thread settings are not saved, set them again)
+	static World *restore(const char *filename);
+};
+
+#endif
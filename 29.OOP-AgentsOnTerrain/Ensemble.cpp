@@ -0,0 +1,486 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ Application
+//	Parameter sweep (ensemble) runner
+//
+//  Runs many replicates of the headless simulation in one process:
+//  every combination of the parameters in a sweep file is a
+//  configuration, and every configuration is run once per seed.
+//  Each replicate is its own World, stepped serially, so a replicate
+//  gives the same result as ./headless with the same parameters,
+//  however many run beside it. The replicates are handed out to all
+//  cores by a ThreadPool, the longest first, one at a time as the
+//  threads become free.
+//
+//  Replicates on the same landscape (size, terrain and landscape
+//  seed) share one Grid and one SimpleTerrain: nothing deforms the
+//  terrain during a run, so height queries only read it.
+//
+//  At the end the outcome of every configuration (snacks eaten,
+//  births, agents left) is averaged over its replicates, printed and
+//  written to a CSV file. --replicates writes one line per replicate
+//  as well, with the checksum of where its agents ended up.
+//
+//  The sweep file has one parameter per line, a name and its values.
+//  A value a:b is every integer from a to b, a:b:step goes in steps
+//  (step may be a fraction). # starts a comment. Parameters left out
+//  keep the defaults of main.cpp and Headless.cpp:
+//
+//    predators 2            # per replicate, at tick 0
+//    preys     4
+//    snacks    6
+//    distance  20           # how far predators and preys seek
+//    fov       -1           # -5.0 = 45 degree from angle FOV
+//    size      100          # width and length of the world
+//    terrain   4            # quads along each side of the terrain
+//    landscape 1            # seed of the terrain heights
+//    seeds     1            # seed of the agents, one replicate each
+//    ticks     5000         # length of every replicate
+//
+//  e.g. "preys 4 40 400" and "seeds 1:100" make 3 configurations
+//  of 100 replicates each. landscape 1 and seeds 1 give the same run
+//  as ./headless --seed 1.
+//
+//  ----------------------------------------------------------
+//  How to compile:
+//  g++ -O2 -I/usr/include/ Ensemble.cpp SimpleTerrain.cpp Agent.cpp Predator.cpp Prey.cpp Snack.cpp Grid.cpp SpatialHash.cpp Population.cpp ThreadPool.cpp World.cpp AgentRenderer.cpp Profiler.cpp -o ensemble -L/usr/lib -lGL -lGLU -pthread
+//
+//  How to run:
+//  ./ensemble --sweep sweep.txt --threads 0 --out ensemble.csv
+//  ./ensemble --sweep sweep.txt --replicates replicates.csv
+//  (--threads 0 uses every core)
+//	##########################################################
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <stdlib.h>
+#include <math.h>
+#include "OGLUtil.h"
+#include "World.h"
+#include "ThreadPool.h"
+#include "Timing.h"
+
+using namespace std;
+
+// the parameters of a sweep, in the order of the configuration loops
+enum { P_PREDATORS, P_PREYS, P_SNACKS, P_DISTANCE, P_FOV, P_SIZE, P_TERRAIN, P_LANDSCAPE, P_TICKS, NO_OF_PARAMETERS };
+
+// a World talks to cout when it is made, given its senses and deleted
+// (its update() does not); cout is muted but still not to be written
+// from two threads at once, so one world at a time does those
+static mutex chatter;
+
+static const char *parameterNames[NO_OF_PARAMETERS] = {
+    "predators", "preys", "snacks", "distance", "fov", "size", "terrain", "landscape", "ticks"
+};
+
+// one combination of parameter values
+struct CONFIGURATION
+{
+    double value[NO_OF_PARAMETERS];
+    int landscape;                  // index into the shared landscapes
+};
+
+// a Grid and SimpleTerrain used by every replicate that asks for them
+struct LANDSCAPE
+{
+    int size, quads;
+    unsigned int seed;
+    Grid *grid;
+    SimpleTerrain *terrain;
+};
+
+// one run of one configuration
+struct REPLICATE
+{
+    int configuration;
+    unsigned int seed;
+
+    // outcome
+    long eaten;                     // snacks eaten (World::noOfMeals)
+    long births;
+    int agentNo;                    // at the end
+    unsigned int checksum;
+    double seconds;
+};
+
+/****************************** PROTOTYPES ******************************/
+bool readSweep(const char *fileName, vector<double> *values, vector<unsigned int> &seeds);
+bool parseValues(istringstream &line, vector<double> &values);
+void runReplicate(const CONFIGURATION &configuration, LANDSCAPE &landscape, REPLICATE &replicate);
+unsigned int checksum(World *world);
+void report(const vector<CONFIGURATION> &configurations, const vector<REPLICATE> &replicates, const char *fileName);
+void writeReplicates(const vector<CONFIGURATION> &configurations, const vector<REPLICATE> &replicates, const char *fileName);
+
+/****************************** MAIN METHOD ******************************/
+int main(int argc, char**argv)
+{
+    string sweepFile;
+    int threads = 0;                // 0 = one per core
+    string outFile = "ensemble.csv";
+    string replicatesFile;          // every replicate on its own (optional)
+
+    // read the command line options
+    for(int i = 1; i + 1 < argc; i += 2)
+    {
+        string option = argv[i];
+        if (option == "--sweep") sweepFile = argv[i+1];
+        else if (option == "--threads") threads = atoi(argv[i+1]);
+        else if (option == "--out") outFile = argv[i+1];
+        else if (option == "--replicates") replicatesFile = argv[i+1];
+        else
+        {
+            cout<<"Unknown option: "<<option<<endl;
+            return 1;
+        }
+    }
+    if (sweepFile.empty())
+    {
+        cout<<"Usage: ./ensemble --sweep sweep.txt [--threads 0] [--out ensemble.csv] [--replicates replicates.csv]"<<endl;
+        return 1;
+    }
+
+    vector<double> values[NO_OF_PARAMETERS];
+    vector<unsigned int> seeds;
+    if (!readSweep(sweepFile.c_str(), values, seeds)) return 1;
+
+    // every combination of values, the first parameter varies slowest
+    vector<CONFIGURATION> configurations;
+    int count[NO_OF_PARAMETERS] = {0};
+    while (true)
+    {
+        CONFIGURATION c;
+        for(int p = 0; p < NO_OF_PARAMETERS; p++) c.value[p] = values[p][count[p]];
+        c.landscape = -1;
+        configurations.push_back(c);
+
+        int p = NO_OF_PARAMETERS - 1;
+        while (p >= 0 && ++count[p] == (int)values[p].size()) count[p--] = 0;
+        if (p < 0) break;
+    }
+
+    // one landscape per size, terrain and landscape seed
+    vector<LANDSCAPE> landscapes;
+    for(size_t c = 0; c < configurations.size(); c++)
+    {
+        CONFIGURATION &configuration = configurations[c];
+        int size = (int)configuration.value[P_SIZE];
+        int quads = (int)configuration.value[P_TERRAIN];
+        unsigned int seed = (unsigned int)configuration.value[P_LANDSCAPE];
+
+        for(size_t l = 0; l < landscapes.size(); l++)
+            if (landscapes[l].size == size && landscapes[l].quads == quads && landscapes[l].seed == seed)
+                configuration.landscape = l;
+
+        if (configuration.landscape < 0)
+        {
+            LANDSCAPE landscape = {size, quads, seed, NULL, NULL};
+            configuration.landscape = landscapes.size();
+            landscapes.push_back(landscape);
+        }
+    }
+
+    vector<REPLICATE> replicates;
+    for(size_t c = 0; c < configurations.size(); c++)
+        for(size_t s = 0; s < seeds.size(); s++)
+        {
+            REPLICATE replicate = {(int)c, seeds[s], 0, 0, 0, 0, 0.0};
+            replicates.push_back(replicate);
+        }
+
+    // the longest replicates first, so that no thread is left with a
+    // long one at the end while the others wait
+    vector<int> order(replicates.size());
+    for(size_t r = 0; r < order.size(); r++) order[r] = r;
+    stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        const double *va = configurations[replicates[a].configuration].value;
+        const double *vb = configurations[replicates[b].configuration].value;
+        double costA = (va[P_PREDATORS] + va[P_PREYS] + va[P_SNACKS]) * va[P_TICKS];
+        double costB = (vb[P_PREDATORS] + vb[P_PREYS] + vb[P_SNACKS]) * vb[P_TICKS];
+        return costA > costB;
+    });
+
+    if (threads <= 0) threads = thread::hardware_concurrency();
+    if (threads <= 0) threads = 1;
+
+    cout<<"------- ENSEMBLE STARTED"<<endl;
+    cout<<"configurations: "<<configurations.size()<<" | replicates: "<<replicates.size()
+        <<" | landscapes: "<<landscapes.size()<<" | threads: "<<threads<<endl;
+
+    // the worlds talk a lot when they are made and deleted
+    silence(true);
+
+    for(size_t l = 0; l < landscapes.size(); l++)
+    {
+        LANDSCAPE &landscape = landscapes[l];
+        landscape.grid = new Grid(landscape.size, landscape.size, 10.0f);
+        landscape.terrain = new SimpleTerrain(landscape.quads, landscape.quads, 1.0f,
+            (float)landscape.size / landscape.quads, landscape.seed);
+    }
+
+    double timeStart = secondsNow();
+
+    // one range per thread, each takes the next replicate when it is free
+    ThreadPool *threadPool = new ThreadPool(threads);
+    atomic<int> next(0);
+    threadPool->parallelFor(threads, [&](int /*begin*/, int /*end*/) {
+        int r;
+        while ((r = next++) < (int)order.size())
+        {
+            REPLICATE &replicate = replicates[order[r]];
+            const CONFIGURATION &configuration = configurations[replicate.configuration];
+            runReplicate(configuration, landscapes[configuration.landscape], replicate);
+        }
+    });
+    delete threadPool;
+
+    double elapsed = secondsNow() - timeStart;
+
+    for(size_t l = 0; l < landscapes.size(); l++)
+    {
+        delete landscapes[l].grid;
+        delete landscapes[l].terrain;
+    }
+
+    silence(false);
+
+    double agentTicks = 0.0;
+    for(size_t r = 0; r < replicates.size(); r++)
+    {
+        const double *v = configurations[replicates[r].configuration].value;
+        agentTicks += (v[P_PREDATORS] + v[P_PREYS] + v[P_SNACKS]) * v[P_TICKS];
+    }
+
+    cout<<"------- ENSEMBLE ENDED"<<endl;
+    cout<<replicates.size()<<" replicates in "<<elapsed<<" s"<<endl;
+    cout<<"replicates/s: "<<replicates.size() / elapsed<<endl;
+    cout<<"agent updates/s: "<<agentTicks / elapsed<<endl;
+
+    report(configurations, replicates, outFile.c_str());
+    if (!replicatesFile.empty())
+        writeReplicates(configurations, replicates, replicatesFile.c_str());
+
+    return 0;
+}
+
+// the values of every parameter (defaults for those not given) and the seeds
+bool readSweep(const char *fileName, vector<double> *values, vector<unsigned int> &seeds)
+{
+    ifstream file(fileName);
+    if (!file)
+    {
+        cout<<"Cannot open the sweep file: "<<fileName<<endl;
+        return false;
+    }
+
+    string text;
+    int lineNo = 0;
+    vector<double> seedValues;
+    while (getline(file, text))
+    {
+        lineNo++;
+        size_t comment = text.find('#');
+        if (comment != string::npos) text.erase(comment);
+
+        istringstream line(text);
+        string name;
+        if (!(line >> name)) continue;
+
+        vector<double> *target = NULL;
+        if (name == "seeds") target = &seedValues;
+        for(int p = 0; p < NO_OF_PARAMETERS; p++)
+            if (name == parameterNames[p]) target = &values[p];
+
+        if (target == NULL)
+        {
+            cout<<fileName<<":"<<lineNo<<": unknown parameter "<<name<<endl;
+            return false;
+        }
+        target->clear();
+        if (!parseValues(line, *target) || target->empty())
+        {
+            cout<<fileName<<":"<<lineNo<<": bad values for "<<name<<endl;
+            return false;
+        }
+    }
+
+    // what main.cpp and Headless.cpp use
+    const double defaults[NO_OF_PARAMETERS] = {2, 4, 6, 20.0, -1.0, 100, 4, 1, 5000};
+    for(int p = 0; p < NO_OF_PARAMETERS; p++)
+        if (values[p].empty()) values[p].push_back(defaults[p]);
+    if (seedValues.empty()) seedValues.push_back(1);
+
+    for(size_t s = 0; s < seedValues.size(); s++)
+        seeds.push_back((unsigned int)seedValues[s]);
+
+    return true;
+}
+
+// numbers, a:b (step 1) or a:b:step, until the end of the line
+bool parseValues(istringstream &line, vector<double> &values)
+{
+    string word;
+    while (line >> word)
+    {
+        double from, to, step = 1.0;
+        char *end;
+        from = strtod(word.c_str(), &end);
+        if (end == word.c_str()) return false;
+        if (*end == '\0')
+        {
+            values.push_back(from);
+            continue;
+        }
+
+        if (*end != ':') return false;
+        const char *rest = end + 1;
+        to = strtod(rest, &end);
+        if (end == rest) return false;
+        if (*end == ':')
+        {
+            rest = end + 1;
+            step = strtod(rest, &end);
+            if (end == rest || step <= 0.0) return false;
+        }
+        if (*end != '\0') return false;
+
+        // a little slack so that 0:1:0.1 ends at 1
+        for(int i = 0; from + i * step <= to + step * 1e-6; i++)
+            values.push_back(from + i * step);
+    }
+    return true;
+}
+
+// build, run and measure one world (called from any thread)
+void runReplicate(const CONFIGURATION &configuration, LANDSCAPE &landscape, REPLICATE &replicate)
+{
+    const double *v = configuration.value;
+    double timeStart = secondsNow();
+
+    World *world;
+    {
+        lock_guard<mutex> guard(chatter);
+        world = new World(landscape.grid, landscape.terrain,
+            (int)v[P_PREDATORS], (int)v[P_PREYS], (int)v[P_SNACKS], replicate.seed);
+        world->ownsLandscape = false;
+        world->setSenses((float)v[P_DISTANCE], (float)v[P_FOV]);		// may make a new SpatialHash
+    }
+
+    long ticks = (long)v[P_TICKS];
+    while (world->tick < ticks)
+        world->update();
+
+    replicate.eaten = world->noOfMeals;
+    replicate.births = world->noOfBirths;
+    replicate.agentNo = world->agentNo;
+    replicate.checksum = checksum(world);
+
+    {
+        lock_guard<mutex> guard(chatter);
+        delete world;
+    }
+
+    replicate.seconds = secondsNow() - timeStart;
+}
+
+// FNV-1a hash of every agent's position, equal checksums mean equal runs
+unsigned int checksum(World *world)
+{
+    unsigned int hash = 2166136261u;
+    for(int i = 0; i < world->agentNo; i++)
+    {
+        Vector3f p = world->agents[i]->getPosition();
+        const unsigned char *bytes = (const unsigned char *)&p;
+        for(size_t b = 0; b < 3 * sizeof(float); b++)
+            hash = (hash ^ bytes[b]) * 16777619u;
+    }
+    return hash;
+}
+
+// mean, standard deviation and range of the outcome of every configuration
+void report(const vector<CONFIGURATION> &configurations, const vector<REPLICATE> &replicates, const char *fileName)
+{
+    ofstream csv(fileName);
+    if (!csv) cout<<"Cannot write "<<fileName<<endl;
+
+    for(int p = 0; p < NO_OF_PARAMETERS; p++) csv<<parameterNames[p]<<",";
+    csv<<"replicates,eaten_mean,eaten_sd,eaten_min,eaten_max,eaten_per_prey_per_1000_ticks,births_mean,agents_mean,seconds_mean"<<endl;
+
+    cout<<"------- OUTCOME PER CONFIGURATION"<<endl;
+
+    // the replicates of a configuration are next to each other
+    size_t r = 0;
+    for(size_t c = 0; c < configurations.size(); c++)
+    {
+        const double *v = configurations[c].value;
+        int n = 0;
+        double sum = 0.0, sum2 = 0.0, births = 0.0, agents = 0.0, seconds = 0.0;
+        long least = 0, most = 0;
+
+        for(; r < replicates.size() && replicates[r].configuration == (int)c; r++)
+        {
+            const REPLICATE &replicate = replicates[r];
+            if (n == 0 || replicate.eaten < least) least = replicate.eaten;
+            if (n == 0 || replicate.eaten > most) most = replicate.eaten;
+            sum += replicate.eaten;
+            sum2 += (double)replicate.eaten * replicate.eaten;
+            births += replicate.births;
+            agents += replicate.agentNo;
+            seconds += replicate.seconds;
+            n++;
+        }
+
+        double mean = sum / n;
+        double sd = n > 1 ? sqrt(max(0.0, (sum2 - n * mean * mean) / (n - 1))) : 0.0;
+        double perPrey = v[P_PREYS] > 0 ? 1000.0 * mean / (v[P_PREYS] * v[P_TICKS]) : 0.0;
+
+        for(int p = 0; p < NO_OF_PARAMETERS; p++) csv<<v[p]<<",";
+        csv<<n<<","<<mean<<","<<sd<<","<<least<<","<<most<<","<<perPrey<<","
+           <<births / n<<","<<agents / n<<","<<seconds / n<<endl;
+
+        cout<<"#"<<c;
+        for(int p = 0; p < NO_OF_PARAMETERS; p++) cout<<" "<<parameterNames[p]<<" "<<v[p];
+        cout<<endl;
+        cout<<"    eaten: "<<mean<<" +- "<<sd<<" ["<<least<<", "<<most<<"] | per prey per 1000 ticks: "<<perPrey
+            <<" | replicates: "<<n<<endl;
+    }
+
+    cout<<"written to "<<fileName<<endl;
+}
+
+// one line per replicate, in the order of the configurations
+void writeReplicates(const vector<CONFIGURATION> &configurations, const vector<REPLICATE> &replicates, const char *fileName)
+{
+    ofstream csv(fileName);
+    if (!csv)
+    {
+        cout<<"Cannot write "<<fileName<<endl;
+        return;
+    }
+
+    csv<<"configuration,";
+    for(int p = 0; p < NO_OF_PARAMETERS; p++) csv<<parameterNames[p]<<",";
+    csv<<"seed,eaten,births,agents,checksum,seconds"<<endl;
+
+    for(size_t r = 0; r < replicates.size(); r++)
+    {
+        const REPLICATE &replicate = replicates[r];
+        const double *v = configurations[replicate.configuration].value;
+
+        csv<<replicate.configuration<<",";
+        for(int p = 0; p < NO_OF_PARAMETERS; p++) csv<<v[p]<<",";
+        csv<<replicate.seed<<","<<replicate.eaten<<","<<replicate.births<<","<<replicate.agentNo<<","
+           <<hex<<replicate.checksum<<dec<<","<<replicate.seconds<<endl;
+    }
+
+    cout<<"replicates written to "<<fileName<<endl;
+}
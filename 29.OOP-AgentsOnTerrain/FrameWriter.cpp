@@ -0,0 +1,195 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ Frame Recorder (headless video)
+//
+//	See FrameWriter.h for the rationale
+//
+//	##########################################################
+
+#include <iostream>
+#include <string.h>
+#include "FrameWriter.h"
+#include "Timing.h"
+
+using namespace std;
+
+FrameWriter::FrameWriter(const char *_prefix, int _width, int _height, int _every, int _noOfFrames)
+{
+	prefix = _prefix;
+	every = (_every < 1) ? 1 : _every;
+	width = _width;
+	height = _height;
+	noOfFrames = _noOfFrames;
+	open = false;
+
+	framesWritten = 0;
+	bytesWritten = 0;
+	captureSeconds = 0.0;
+
+	// as many frames as fit in 64MB (2 to 64)
+	long frameBytes = (long)width * height * 4;
+	if (noOfFrames < 1)
+	{
+		noOfFrames = (64L << 20) / frameBytes;
+		if (noOfFrames < 2) noOfFrames = 2;
+		if (noOfFrames > 64) noOfFrames = 64;
+	}
+
+	frames = new IMAGEFRAME[noOfFrames];
+	for(int f = 0; f < noOfFrames; f++)
+	{
+		frames[f].tick = 0;
+		frames[f].pixels = new unsigned char[frameBytes];
+	}
+	writer = new BackgroundWriter<IMAGEFRAME>(frames, noOfFrames);
+	row = new unsigned char[(size_t)width * 3];
+
+	camera = NULL;
+	packBuffers[0] = packBuffers[1] = 0;
+
+	offscreen = new OffscreenContext(width, height);
+	if (!offscreen->isReady()) return;
+
+	// the same view as the window of main.cpp when it opens
+	camera = new Camera(Vector3f(0.0f, 30.0f, 60.0f), Vector3f(0.0f, 0.0f, -1.0f), 0.2f, 3.0f, 20.0f);
+
+	glGenBuffers(2, packBuffers);
+	for(int b = 0; b < 2; b++)
+	{
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, packBuffers[b]);
+		glBufferData(GL_PIXEL_PACK_BUFFER, frameBytes, NULL, GL_STREAM_READ);
+		packTicks[b] = -1;
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	packNext = 0;
+
+	open = true;
+	writer->start([this](IMAGEFRAME *frame) { writeFrame(frame); });
+
+	cout<<"---------------------------------->> Recording "<<width<<"x"<<height<<" frames to "<<prefix<<"*.ppm every "<<every<<" ticks"<<endl;
+}
+
+void FrameWriter::capture(World *world)
+{
+	if (!open || world->tick % every != 0) return;
+
+	double t0 = secondsNow();
+
+	// draw the scene as the main loop of main.cpp does
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	glLoadIdentity();
+	camera->update();
+	gluLookAt(camera->x, camera->y, camera->z, camera->tx, camera->ty, camera->tz, 0.0f, 1.0f, 0.0f);
+	glPushMatrix();
+		world->render();
+	glPopMatrix();
+
+	// start reading this frame back, into a buffer, without waiting for it
+	{
+		PROFILE("frame readback");
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, packBuffers[packNext]);
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (GLvoid *)0);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		packTicks[packNext] = world->tick;
+
+		// and hand over the previous one, which has arrived by now
+		packNext = 1 - packNext;
+		collect(packNext);
+	}
+
+	captureSeconds += secondsNow() - t0;
+}
+
+void FrameWriter::collect(int buffer)
+{
+	if (packTicks[buffer] < 0) return;
+
+	// waits for the writer to give a frame back if it has fallen behind
+	IMAGEFRAME *frame = writer->acquire();
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, packBuffers[buffer]);
+	const unsigned char *pixels = (const unsigned char *)glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+	if (pixels != NULL)
+	{
+		memcpy(frame->pixels, pixels, (size_t)width * height * 4);
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	frame->tick = packTicks[buffer];
+	packTicks[buffer] = -1;
+
+	if (pixels == NULL)
+	{
+		writer->release(frame);
+		return;
+	}
+
+	writer->submit(frame);
+}
+
+// binary PPM (P6): the rows top first, RGB without alpha
+void FrameWriter::writeFrame(IMAGEFRAME *frame)
+{
+	char filename[1024];
+	snprintf(filename, sizeof(filename), "%s%06ld.ppm", prefix.c_str(), frame->tick);
+
+	FILE *file = fopen(filename, "wb");
+	if (file == NULL)
+	{
+		cout<<">> Frame could not be written: "<<filename<<endl;
+		return;
+	}
+
+	int headerBytes = fprintf(file, "P6\n%d %d\n255\n", width, height);
+	for(int y = height - 1; y >= 0; y--)
+	{
+		const unsigned char *rgba = frame->pixels + (size_t)y * width * 4;
+		for(int x = 0; x < width; x++)
+		{
+			row[3*x] = rgba[4*x];
+			row[3*x + 1] = rgba[4*x + 1];
+			row[3*x + 2] = rgba[4*x + 2];
+		}
+		fwrite(row, 1, (size_t)width * 3, file);
+	}
+	fclose(file);
+
+	framesWritten++;
+	bytesWritten += headerBytes + (uint64_t)width * height * 3;
+}
+
+void FrameWriter::close()
+{
+	if (!open) return;
+
+	// the last frame drawn is still in its pack buffer
+	collect(1 - packNext);
+
+	writer->stop();
+	open = false;
+}
+
+void FrameWriter::printStats()
+{
+	cout<<"frames: "<<framesWritten<<" images, "<<bytesWritten / (1024.0 * 1024.0)<<" MB, "
+		<<captureSeconds<<" s drawing and capturing, "<<writer->getStalls()<<" waits for the writer"<<endl;
+}
+
+FrameWriter::~FrameWriter()
+{
+	close();
+
+	if (packBuffers[0] != 0) glDeleteBuffers(2, packBuffers);
+	delete camera;
+	delete offscreen;
+
+	delete writer;
+	delete[] row;
+	for(int f = 0; f < noOfFrames; f++)
+		delete[] frames[f].pixels;
+	delete[] frames;
+}
@@ -0,0 +1,87 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ Frame Recorder (headless video)
+//
+//	Draws the World every N ticks into an OffscreenContext, seen
+//	through a Camera placed as in main.cpp, and writes each frame
+//	as a PPM image: prefix000000.ppm, prefix000010.ppm, ... named
+//	by tick. A movie is made afterwards, e.g. with
+//	  ffmpeg -framerate 30 -pattern_type glob -i 'prefix*.ppm' run.mp4
+//
+//	The simulation thread never waits for the pixels it has just
+//	drawn. glReadPixels() goes into one of two pixel buffer objects
+//	and returns at once; the pixels are collected from that buffer
+//	at the next capture, when they have long arrived. The copy is
+//	handed to a BackgroundWriter (as in TrajectoryWriter), whose
+//	thread flips the rows, drops alpha and writes the file, so
+//	nothing is allocated during a run.
+//
+//	##########################################################
+
+#ifndef FRAMEWRITER_H
+#define FRAMEWRITER_H
+
+#include <stdio.h>
+#include <string>
+#include "BackgroundWriter.h"
+#include "OffscreenContext.h"
+#include "Camera.h"
+#include "World.h"
+
+// one captured image, RGBA, bottom row first (as glReadPixels gives it)
+struct IMAGEFRAME
+{
+	long tick;
+	unsigned char *pixels;
+};
+
+/****************************** PROTOTYPES ******************************/
+class FrameWriter
+{
+private:
+	string prefix;								// path and start of every file name
+	int every;										// capture every so many ticks
+	int width, height;
+
+	OffscreenContext *offscreen;
+	Camera *camera;
+
+	// glReadPixels() targets, written one capture and read the next
+	GLuint packBuffers[2];
+	long packTicks[2];						// -1 when the buffer holds no frame
+	int packNext;
+
+	IMAGEFRAME *frames;
+	int noOfFrames;
+	BackgroundWriter<IMAGEFRAME> *writer;
+	unsigned char *row;						// one RGB row, used on the writer's thread
+	bool open;
+
+	// statistics
+	long framesWritten;
+	uint64_t bytesWritten;
+	double captureSeconds;				// time spent in capture() on the simulation thread
+
+	void collect(int buffer);			// copy a pack buffer into a frame for the writer
+	void writeFrame(IMAGEFRAME *frame);		// on the writer's thread
+
+public:
+	// _noOfFrames frames can be queued for writing, 0 sizes the queue to 64MB
+	FrameWriter(const char *_prefix, int _width, int _height, int _every, int _noOfFrames = 0);
+	~FrameWriter();
+
+	bool isOpen() { return open; }
+
+	// called after every tick, draws and captures the world when tick is a multiple of every
+	void capture(World *world);
+
+	// write what is still queued (also done by the destructor)
+	void close();
+
+	double getCaptureSeconds() { return captureSeconds; }
+	void printStats();
+};
+
+#endif
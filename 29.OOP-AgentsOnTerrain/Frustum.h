@@ -0,0 +1,122 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ View Frustum Class (what the camera can see)
+//
+//	Everything is sent to the graphics card every frame, although
+//	the camera only ever looks at part of the world. The frustum is
+//	the part it can see: the six planes of gluPerspective() placed
+//	where gluLookAt() puts the eye. A bounding box entirely behind
+//	one plane cannot be seen, and whatever is inside it (a piece of
+//	terrain, a cell of agents) need not be drawn.
+//
+//	The planes are worked out from the camera (eye, target, up) and
+//	the perspective (field of view, aspect, near and far), not read
+//	back from OpenGL, so nothing waits on the graphics card.
+//
+//	##########################################################
+
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <math.h>
+#include "Vector3f.h"
+
+// an axis-aligned box around something drawn
+struct BOUNDINGBOX
+{
+	float minX, minY, minZ;
+	float maxX, maxY, maxZ;
+};
+
+// a*x + b*y + c*z + d, positive on the inside
+struct FRUSTUMPLANE
+{
+	float a, b, c, d;
+};
+
+/****************************** PROTOTYPES ******************************/
+class Frustum
+{
+private:
+	FRUSTUMPLANE planes[6];		// near, far, left, right, bottom, top
+
+	static FRUSTUMPLANE plane(const Vector3f &normal, const Vector3f &point)
+	{
+		FRUSTUMPLANE p;
+		p.a = normal.x;
+		p.b = normal.y;
+		p.c = normal.z;
+		p.d = -(normal.x * point.x + normal.y * point.y + normal.z * point.z);
+		return p;
+	}
+
+	static Vector3f unit(Vector3f v)
+	{
+		v.normalise();
+		return v;
+	}
+
+public:
+	Vector3f eye;		// for the distance of what is drawn (level of detail)
+
+	Frustum()
+	{
+		// sees everything until set()
+		for(int i = 0; i < 6; i++)
+		{
+			planes[i].a = planes[i].b = planes[i].c = 0.0f;
+			planes[i].d = 1.0f;
+		}
+	}
+
+	// what gluPerspective(fovy, aspect, zNear, zFar) then gluLookAt(eye, target, up) see
+	void set(const Vector3f &_eye, const Vector3f &target, const Vector3f &up,
+		float fovy, float aspect, float zNear, float zFar)
+	{
+		eye = _eye;
+
+		Vector3f forward = unit(target - eye);
+		Vector3f right = unit(forward.crossProduct(up));
+		Vector3f top = right.crossProduct(forward);
+
+		float tanV = tan(fovy * 0.5f * M_PI / 180.0f);
+		float tanH = tanV * aspect;
+
+		planes[0] = plane(forward, eye + forward * zNear);
+		planes[1] = plane(-forward, eye + forward * zFar);
+
+		// each side contains the eye, its normal leans towards the view axis
+		planes[2] = plane(unit(right + forward * tanH), eye);
+		planes[3] = plane(unit(-right + forward * tanH), eye);
+		planes[4] = plane(unit(top + forward * tanV), eye);
+		planes[5] = plane(unit(-top + forward * tanV), eye);
+	}
+
+	// false only if the box is certainly out of sight: for each plane the
+	// corner furthest along its normal is tested
+	bool sees(const BOUNDINGBOX &box) const
+	{
+		for(int i = 0; i < 6; i++)
+		{
+			const FRUSTUMPLANE &p = planes[i];
+			float x = (p.a >= 0.0f) ? box.maxX : box.minX;
+			float y = (p.b >= 0.0f) ? box.maxY : box.minY;
+			float z = (p.c >= 0.0f) ? box.maxZ : box.minZ;
+			if (p.a * x + p.b * y + p.c * z + p.d < 0.0f) return false;
+		}
+		return true;
+	}
+
+	// from the eye to the nearest point of the box, 0 inside it
+	float distance(const BOUNDINGBOX &box) const
+	{
+		float dx = (eye.x < box.minX) ? box.minX - eye.x : ((eye.x > box.maxX) ? eye.x - box.maxX : 0.0f);
+		float dy = (eye.y < box.minY) ? box.minY - eye.y : ((eye.y > box.maxY) ? eye.y - box.maxY : 0.0f);
+		float dz = (eye.z < box.minZ) ? box.minZ - eye.z : ((eye.z > box.maxZ) ? eye.z - box.maxZ : 0.0f);
+		return sqrt(dx*dx + dy*dy + dz*dz);
+	}
+};
+
+#endif
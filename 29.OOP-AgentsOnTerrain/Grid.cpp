@@ -158,6 +158,21 @@ float Grid::getRight()
 	return _right;
 }
 
+float Grid::getWidth()
+{
+	return gridWidth;
+}
+
+float Grid::getHeight()
+{
+	return gridHeight;
+}
+
+float Grid::getSegments()
+{
+	return noSegments;
+}
+
 /******************************** destructor ********************************/
 Grid::~Grid()
 {
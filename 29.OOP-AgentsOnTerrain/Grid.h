@@ -43,6 +43,9 @@ public:
 	float getBottom();
 	float getLeft();
 	float getRight();
+	float getWidth();
+	float getHeight();
+	float getSegments();
 
 	void render();				// Draw Grid
 
@@ -0,0 +1,254 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ Application
+//	Headless (render-free) simulation runner
+//
+//  Builds the same World as main.cpp (Grid, SimpleTerrain and the
+//  predator/prey/snack population) but never calls SDL_Init or
+//  creates an OpenGL context, so it runs on servers without a
+//  display. update() is stepped as fast as the machine allows,
+//  with no 60 ticks/s frame limiter, for a number of ticks or
+//  until a wall-clock budget runs out, whichever comes first.
+//
+//  --save writes a Checkpoint when the run ends (and every --every
+//  ticks), --restore continues from one instead of building a new
+//  World. --ticks counts from tick 0, so a restored run stops at the
+//  same tick the uninterrupted run would have.
+//
+//  --record writes every agent's position and heading every
+//  --record-every ticks to a trajectory file (see TrajectoryWriter.h)
+//
+//  --stats writes the population, speed, distance to target, density
+//  over the grid cells, height on the terrain and the meals, births and
+//  deaths every --stats-every ticks, added up while the simulation runs
+//  (see Statistics.h)
+//
+//  --frames draws the world every --frame-every ticks into an
+//  offscreen OpenGL context (no window, no GPU needed, see
+//  OffscreenContext.h) and writes the frames as PPM images
+//  (see FrameWriter.h)
+//
+//  --conflict decides which prey gets a snack that several preys
+//  reach in the same tick: first (the lowest id) or random (drawn
+//  from the seed), see World::resolveInteractions
+//
+//  --profile switches the Profiler on, prints where the time went
+//  and writes the events to a Chrome trace file at the end
+//
+//  ----------------------------------------------------------
+//  How to compile:
+//  g++ -O2 -I/usr/include/ Headless.cpp SimpleTerrain.cpp Agent.cpp Predator.cpp Prey.cpp Snack.cpp Grid.cpp SpatialHash.cpp Population.cpp ThreadPool.cpp World.cpp AgentRenderer.cpp Checkpoint.cpp TrajectoryWriter.cpp Statistics.cpp Camera.cpp OffscreenContext.cpp FrameWriter.cpp Profiler.cpp -o headless -L/usr/lib -lGL -lGLU -lEGL -pthread
+//  (without --frames nothing is drawn and no OpenGL context is made)
+//
+//  How to run:
+//  ./headless --ticks 100000 --seconds 60 --predators 2 --preys 4 --snacks 6 --batch 0 --threads 0 --seed 1 --conflict first
+//  ./headless --ticks 100000 --save run.ckpt --every 10000
+//  ./headless --ticks 100000 --restore run.ckpt --save run.ckpt --every 10000
+//  ./headless --ticks 100000 --record run.traj --record-every 10
+//  ./headless --ticks 100000 --stats run.stat --stats-every 1
+//  ./headless --ticks 1000 --threads 4 --profile profile.json
+//  ./headless --ticks 100000 --conflict random
+//  ./headless --ticks 6000 --frames frames/run --frame-every 10 --frame-width 800 --frame-height 800
+//  every option is optional, the defaults are shown above
+//	##########################################################
+
+#include <iostream>
+#include <string>
+#include <stdlib.h>
+#include "OGLUtil.h"
+#include "World.h"
+#include "Checkpoint.h"
+#include "TrajectoryWriter.h"
+#include "Statistics.h"
+#include "FrameWriter.h"
+#include "Profiler.h"
+#include "Timing.h"
+
+using namespace std;
+
+/****************************** PROTOTYPES ******************************/
+unsigned int checksum(World *world);
+
+/****************************** MAIN METHOD ******************************/
+int main(int argc, char**argv)
+{
+    long maxTicks = 100000;     // stop after this many ticks
+    double maxSeconds = 60.0;   // or after this much wall-clock time
+    int predatorNo = 2;
+    int preyNo = 4;
+    int snackNo = 6;
+    bool batch = false;         // move agents with Population::integrateMotion()
+    int threads = 0;            // >0 steps agents in parallel from a snapshot
+    unsigned int seed = 1;      // same seed, same run
+    string saveFile;            // checkpoint written at the end of the run
+    long saveEvery = 0;         // and every so many ticks (0 = only at the end)
+    string restoreFile;         // checkpoint to continue from
+    string recordFile;          // trajectory file
+    int recordEvery = 10;       // ticks between recorded frames
+    string statsFile;           // statistics time series
+    int statsEvery = 1;         // ticks between records
+    string framePrefix;         // path and start of the frame image names
+    int frameEvery = 10;        // ticks between frames
+    int frameWidth = 800;
+    int frameHeight = 800;
+    string profileFile;         // Chrome trace of the run
+    string conflict = "first";  // or random
+
+    // read the command line options
+    for(int i = 1; i + 1 < argc; i += 2)
+    {
+        string option = argv[i];
+        if (option == "--ticks") maxTicks = atol(argv[i+1]);
+        else if (option == "--seconds") maxSeconds = atof(argv[i+1]);
+        else if (option == "--predators") predatorNo = atoi(argv[i+1]);
+        else if (option == "--preys") preyNo = atoi(argv[i+1]);
+        else if (option == "--snacks") snackNo = atoi(argv[i+1]);
+        else if (option == "--batch") batch = atoi(argv[i+1]) != 0;
+        else if (option == "--threads") threads = atoi(argv[i+1]);
+        else if (option == "--seed") seed = strtoul(argv[i+1], NULL, 10);
+        else if (option == "--save") saveFile = argv[i+1];
+        else if (option == "--every") saveEvery = atol(argv[i+1]);
+        else if (option == "--restore") restoreFile = argv[i+1];
+        else if (option == "--record") recordFile = argv[i+1];
+        else if (option == "--record-every") recordEvery = atoi(argv[i+1]);
+        else if (option == "--stats") statsFile = argv[i+1];
+        else if (option == "--stats-every") statsEvery = atoi(argv[i+1]);
+        else if (option == "--frames") framePrefix = argv[i+1];
+        else if (option == "--frame-every") frameEvery = atoi(argv[i+1]);
+        else if (option == "--frame-width") frameWidth = atoi(argv[i+1]);
+        else if (option == "--frame-height") frameHeight = atoi(argv[i+1]);
+        else if (option == "--profile") profileFile = argv[i+1];
+        else if (option == "--conflict") conflict = argv[i+1];
+        else
+        {
+            cout<<"Unknown option: "<<option<<endl;
+            return 1;
+        }
+    }
+
+    World *world;
+    if (restoreFile.empty())
+        world = new World(predatorNo, preyNo, snackNo, seed);
+    else
+    {
+        world = Checkpoint::restore(restoreFile.c_str());
+        if (world == NULL) return 1;
+    }
+    world->setBatchKinematics(batch);
+    world->setConflictRule(conflict == "random" ? CONFLICT_RANDOM_BY_SEED : CONFLICT_FIRST_BY_ID);
+    world->setThreads(threads);
+
+    TrajectoryWriter *recorder = NULL;
+    if (!recordFile.empty())
+        recorder = new TrajectoryWriter(recordFile.c_str(), world->agentNo, recordEvery);
+
+    Statistics *stats = NULL;
+    if (!statsFile.empty())
+        stats = new Statistics(statsFile.c_str(), world, statsEvery);
+
+    // the OpenGL context must exist before the world is first drawn
+    FrameWriter *frames = NULL;
+    if (!framePrefix.empty())
+    {
+        frames = new FrameWriter(framePrefix.c_str(), frameWidth, frameHeight, frameEvery);
+        if (!frames->isOpen()) return 1;
+    }
+
+    // --------------------- SIMULATION BLOCK
+    cout<<"------- HEADLESS SIMULATION BLOCK STARTED"<<endl;
+    cout<<"ticks: "<<maxTicks<<" | seconds: "<<maxSeconds<<" | agents: "<<world->agentNo<<endl;
+
+    if (!profileFile.empty()) Profiler::setEnabled(true);
+
+    long firstTick = world->tick;
+    double timeStart = secondsNow();
+    double elapsed = 0.0;
+    while (world->tick < maxTicks)
+    {
+        world->update();
+
+        if (recorder != NULL)
+            recorder->capture(world);
+
+        if (stats != NULL)
+            stats->capture(world);
+
+        if (frames != NULL)
+            frames->capture(world);
+
+        if (saveEvery > 0 && !saveFile.empty() && world->tick % saveEvery == 0)
+            Checkpoint::save(world, saveFile.c_str());
+
+        // reading the clock is cheap next to a tick, but not free
+        if ((world->tick & 63) == 0)
+        {
+            elapsed = secondsNow() - timeStart;
+            if (elapsed >= maxSeconds) break;
+        }
+    }
+    elapsed = secondsNow() - timeStart;
+
+    cout<<"------- HEADLESS SIMULATION BLOCK ENDED"<<endl;
+    long ticksRun = world->tick - firstTick;
+    cout<<"ticks: "<<ticksRun<<" in "<<elapsed<<" s (at tick "<<world->tick<<")"<<endl;
+    cout<<"ticks/s: "<<ticksRun / elapsed<<endl;
+    cout<<"agent updates/s: "<<(ticksRun * (double)world->agentNo) / elapsed<<endl;
+    cout<<"births: "<<world->noOfBirths<<" | deaths: "<<world->noOfDeaths<<endl;
+    cout<<"interactions: "<<world->noOfInteractions<<" | lost to another agent: "<<world->noOfConflicts<<endl;
+    cout<<"state checksum: "<<hex<<checksum(world)<<dec<<endl;
+
+    if (!profileFile.empty())
+    {
+        Profiler::setEnabled(false);
+        Profiler::printSummary();
+        Profiler::writeChromeTrace(profileFile.c_str());
+    }
+
+    if (recorder != NULL)
+    {
+        recorder->close();
+        recorder->printStats();
+        cout<<"recording cost: "<<100.0 * recorder->getCaptureSeconds() / elapsed<<"% of the run"<<endl;
+        delete recorder;
+    }
+
+    if (stats != NULL)
+    {
+        stats->close();
+        stats->printStats();
+        cout<<"statistics cost: "<<100.0 * stats->getCaptureSeconds() / elapsed<<"% of the run"<<endl;
+        delete stats;
+    }
+
+    if (frames != NULL)
+    {
+        frames->close();
+        frames->printStats();
+        cout<<"frame capture cost: "<<100.0 * frames->getCaptureSeconds() / elapsed<<"% of the run"<<endl;
+    }
+
+    if (!saveFile.empty())
+        Checkpoint::save(world, saveFile.c_str());
+
+    // the world's buffers on the graphics side go before the context does
+    delete world;
+    delete frames;
+
+    return 0;
+}
+
+// FNV-1a hash of every agent's position, equal checksums mean equal runs
+unsigned int checksum(World *world)
+{
+    unsigned int hash = 2166136261u;
+    for(int i = 0; i < world->agentNo; i++)
+    {
+        Vector3f p = world->agents[i]->getPosition();
+        const unsigned char *bytes = (const unsigned char *)&p;
+        for(size_t b = 0; b < 3 * sizeof(float); b++)
+            hash = (hash ^ bytes[b]) * 16777619u;
+    }
+    return hash;
+}
@@ -0,0 +1,74 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ Interaction Buffer (what agents want to do to each other)
+//
+//	An agent that eats a snack used to change the snack there and
+//	then, in the middle of its own update. With the agents updated
+//	on several threads that is one thread writing an agent another
+//	thread may be reading, and two preys could both eat the same
+//	snack in one tick.
+//
+//	Instead an agent only states what it intends (so far: a prey
+//	eating a snack) in an InteractionBuffer. Each thread of the update has a
+//	buffer of its own that no other thread writes, so pushing needs
+//	no lock and no atomic: the end of parallelFor is the only
+//	synchronisation needed before the buffers are read. World then
+//	resolves all intents at the end of the tick, in an order that
+//	does not depend on the threads (see World::resolveInteractions).
+//
+//	##########################################################
+
+#ifndef INTERACTION_H
+#define INTERACTION_H
+
+#include <vector>
+#include "Category.h"
+
+using namespace std;
+
+// what an agent wants to do to its target
+enum InteractionType
+{
+	INTERACTION_EAT		// the target is eaten (snacks)
+};
+
+// who gets a target wanted by more than one agent in the same tick
+enum ConflictRule
+{
+	CONFLICT_FIRST_BY_ID,		// the lowest id
+	CONFLICT_RANDOM_BY_SEED		// a random one, from the world's seed
+};
+
+struct INTERACTION
+{
+	InteractionType type;
+	int actor;				// id of the agent that wants it
+	int target;				// index in the agents array
+};
+
+/****************************** PROTOTYPES ******************************/
+// written by one thread during the tick, read by World after it
+class InteractionBuffer
+{
+public:
+	vector<INTERACTION> events;
+
+	InteractionBuffer()
+	{
+		events.reserve(64);
+	}
+
+	void push(const INTERACTION &event)
+	{
+		events.push_back(event);
+	}
+
+	void clear()
+	{
+		events.clear();
+	}
+};
+
+#endif
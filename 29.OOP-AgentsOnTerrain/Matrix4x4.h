@@ -3,6 +3,11 @@
 //	Email: genechng@gmail.com
 //	----------------------------------------------------------
 //	A C++ Matrix Class
+//
+//	Nothing here allocates: products are returned by value and
+//	matrices are passed by const reference. Where the compiler
+//	targets SSE (always on x86-64) the matrix product works on whole
+//	rows of four floats at a time.
 //	##########################################################
 
 #ifndef MATRIX4x4_H
@@ -11,6 +16,9 @@
 #include "math.h"
 #include "Vector3f.h"
 #include <iostream>
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
 using namespace std;
 
 // glLoadMatrixf(const GLfloat *matrix);
@@ -20,23 +28,22 @@ class Matrix4x4
 {
 private:
 	// so that the global member &operator* can access this class members
-	friend Vector3f *operator*(const Vector3f v, const Matrix4x4 M)
+	// the point v transformed by M, the same as M.multiply(v)
+	friend Vector3f operator*(const Vector3f &v, const Matrix4x4 &M)
 	{
-	    Vector3f *nV = new Vector3f(
+	    return Vector3f(
 			v.x*M.m11 + v.y*M.m21 + v.z*M.m31 + M.tx,
 			v.x*M.m12 + v.y*M.m22 + v.z*M.m32 + M.ty,
 			v.x*M.m13 + v.y*M.m23 + v.z*M.m33 + M.tz
 			);
-
-	    return nV;
 	}
-	friend ostream &operator<<(ostream& output, const Matrix4x4 mat) {
+	friend ostream &operator<<(ostream& output, const Matrix4x4 &mat) {
 		//output << "(" <<  p.x << ", " << p.y <<")";
 
-		cout<<mat.m11<<" "<<mat.m12<<" "<<mat.m13<<" "<<mat.m14<<endl;
-		cout<<mat.m21<<" "<<mat.m22<<" "<<mat.m23<<" "<<mat.m24<<endl;
-		cout<<mat.m31<<" "<<mat.m32<<" "<<mat.m33<<" "<<mat.m34<<endl;
-		cout<<mat.tx<<" "<<mat.ty<<" "<<mat.tz<<" "<<mat.m44<<endl;
+		output<<mat.m11<<" "<<mat.m12<<" "<<mat.m13<<" "<<mat.m14<<endl;
+		output<<mat.m21<<" "<<mat.m22<<" "<<mat.m23<<" "<<mat.m24<<endl;
+		output<<mat.m31<<" "<<mat.m32<<" "<<mat.m33<<" "<<mat.m34<<endl;
+		output<<mat.tx<<" "<<mat.ty<<" "<<mat.tz<<" "<<mat.m44<<endl;
 
 		return output;  // for multiple << operators.
 	}
@@ -79,10 +86,12 @@ public:
 		//matrix = newMatrix;			// public matrix
 	}
 
-	Matrix4x4(float newM[16])
+	Matrix4x4(const float newM[16])
 	{
 		for(int i=0; i<16; i++)
 			matrix[i] = newM[i];	// public
+
+		fillElements();
 	}
 
 	/******************* functions *******************/
@@ -132,6 +141,18 @@ public:
 		fillMatrix();
 	}
 
+	// the same as rotateY(angle) for cosA = cos(angle), sinA = sin(angle),
+	// for callers that already have them
+	void rotateY(float cosA, float sinA)
+	{
+		m11=cosA;		m12=0;				m13=sinA;		m14=0;
+		m21=0;			m22=1;				m23=0;			m24=0;
+		m31=-sinA;	m32=0;				m33=cosA;		m34=0;
+		m44=1;
+
+		fillMatrix();
+	}
+
 	void rotateZ(float angle)
 	{
 		//identity();	// make matrix identity;
@@ -153,7 +174,7 @@ public:
 		fillMatrix();
 	}
 
-	Vector3f multiply(Vector3f v)
+	Vector3f multiply(const Vector3f &v) const
 	{
 		return Vector3f(
 			v.x*m11 + v.y*m21 + v.z*m31 + tx,
@@ -162,10 +183,35 @@ public:
 			);
 	}
 
-	Matrix4x4 multiply(Matrix4x4 N)
+	// this matrix times N (row vectors: N is applied after this)
+	Matrix4x4 multiply(const Matrix4x4 &N) const
 	{
 		Matrix4x4 newM;
 
+#if defined(__SSE__)
+		// row i of the product is the rows of N weighted by row i of this
+		// matrix, added up in the same order as the scalar code below
+		__m128 n0 = _mm_setr_ps(N.m11, N.m12, N.m13, N.m14);
+		__m128 n1 = _mm_setr_ps(N.m21, N.m22, N.m23, N.m24);
+		__m128 n2 = _mm_setr_ps(N.m31, N.m32, N.m33, N.m34);
+		__m128 n3 = _mm_setr_ps(N.tx, N.ty, N.tz, N.m44);
+
+		const float rows[4][4] = {
+			{m11, m12, m13, m14}, {m21, m22, m23, m24},
+			{m31, m32, m33, m34}, {tx, ty, tz, m44}
+		};
+
+		for(int r=0; r<4; r++)
+		{
+			__m128 row = _mm_mul_ps(_mm_set1_ps(rows[r][0]), n0);
+			row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(rows[r][1]), n1));
+			row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(rows[r][2]), n2));
+			row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(rows[r][3]), n3));
+			_mm_storeu_ps(&newM.matrix[4*r], row);
+		}
+
+		newM.fillElements();
+#else
 		// First Row
 		newM.m11 = m11*N.m11 + m12*N.m21 + m13*N.m31 + m14*N.tx;
 		newM.m12 = m11*N.m12 + m12*N.m22 + m13*N.m32 + m14*N.ty;
@@ -190,6 +236,9 @@ public:
 		newM.tz = tx*N.m13 + ty*N.m23 + tz*N.m33 + m44*N.tz;
 		newM.m44 = tx*N.m14 + ty*N.m24 + tz*N.m34 + m44*N.m44;
 
+		newM.fillMatrix();
+#endif
+
 		return newM;
 	}
 
@@ -237,7 +286,16 @@ public:
 		//return matrix;
 	}
 
-	void print()
+	// the other way round, the elements from matrix[]
+	void fillElements()
+	{
+		m11 = matrix[0];		m12 = matrix[1];		m13 = matrix[2];		m14 = matrix[3];
+		m21 = matrix[4];		m22 = matrix[5];		m23 = matrix[6];		m24 = matrix[7];
+		m31 = matrix[8];		m32 = matrix[9];		m33 = matrix[10];		m34 = matrix[11];
+		tx = matrix[12];		ty = matrix[13];		tz = matrix[14];		m44 = matrix[15];
+	}
+
+	void print() const
 	{
 		cout<<m11<<" "<<m12<<" "<<m13<<" "<<m14<<endl;
 		cout<<m21<<" "<<m22<<" "<<m23<<" "<<m24<<endl;
@@ -246,35 +304,9 @@ public:
 	}
 
 	/******************* operator overloading *******************/
-	Matrix4x4 operator*(const Matrix4x4 N)
+	Matrix4x4 operator*(const Matrix4x4 &N) const
 	{
-		Matrix4x4 newM;
-
-		// First Row
-		newM.m11 = m11*N.m11 + m12*N.m21 + m13*N.m31 + m14*N.tx;
-		newM.m12 = m11*N.m12 + m12*N.m22 + m13*N.m32 + m14*N.ty;
-		newM.m13 = m11*N.m13 + m12*N.m23 + m13*N.m33 + m14*N.tz;
-		newM.m14 = m11*N.m14 + m12*N.m24 + m13*N.m34 + m14*N.m44;
-
-		// Second Row
-		newM.m21 = m21*N.m11 + m22*N.m21 + m23*N.m31 + m24*N.tx;
-		newM.m22 = m21*N.m12 + m22*N.m22 + m23*N.m32 + m24*N.ty;
-		newM.m23 = m21*N.m13 + m22*N.m23 + m23*N.m33 + m24*N.tz;
-		newM.m24 = m21*N.m14 + m22*N.m24 + m23*N.m34 + m24*N.m44;
-
-		// Third Row
-		newM.m31 = m31*N.m11 + m32*N.m21 + m33*N.m31 + m34*N.tx;
-		newM.m32 = m31*N.m12 + m32*N.m22 + m33*N.m32 + m34*N.ty;
-		newM.m33 = m31*N.m13 + m32*N.m23 + m33*N.m33 + m34*N.tz;
-		newM.m34 = m31*N.m14 + m32*N.m24 + m33*N.m34 + m34*N.m44;
-
-		// Fourth Row
-		newM.tx = tx*N.m11 + ty*N.m21 + tz*N.m31 + m44*N.tx;
-		newM.ty = tx*N.m12 + ty*N.m22 + tz*N.m32 + m44*N.ty;
-		newM.tz = tx*N.m13 + ty*N.m23 + tz*N.m33 + m44*N.tz;
-		newM.m44 = tx*N.m14 + ty*N.m24 + tz*N.m34 + m44*N.m44;
-
-		return newM;
+		return multiply(N);
 	}
 
 	// mat1 = mat2;
@@ -285,13 +317,11 @@ public:
 		m31 =	N.m31;		m32 = N.m32;		m33 = N.m33;		m34 = N.m34;
 		tx = N.tx;			ty = N.ty;			tz = N.tz;			m44 = N.m44;
 
+		fillMatrix();
 		return *this;
 	}
 
 
-	/******************* destructor *******************/
-	~Matrix4x4()	{	}
-
 };
 
 /******************* global methods *******************/
@@ -10,7 +10,11 @@
 #define OGLUTIL_H
 
 #include <iostream>
+
+// buffer objects (OpenGL 1.5) are declared only with this defined
+#define GL_GLEXT_PROTOTYPES
 #include <GL/gl.h>
+#include <GL/glext.h>
 #include <GL/glu.h>
 #include <SDL2/SDL.h>
 #include <math.h>
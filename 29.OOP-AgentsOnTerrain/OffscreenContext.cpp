@@ -0,0 +1,138 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ Offscreen OpenGL Context
+//
+//	See OffscreenContext.h for the rationale
+//
+//	##########################################################
+
+#include "OffscreenContext.h"
+#include <EGL/eglext.h>
+
+// ----------------------- Light Variables (as in main.cpp)
+static GLfloat ambientLight[] = {0.5f, 0.5f, 0.5f, 1.0f};
+static GLfloat diffuseLight[] = {1.0f, 1.0f, 1.0f, 1.0f};
+static GLfloat matAmbient[] = {1.0f, 1.0f, 1.0f, 1.0f};
+
+OffscreenContext::OffscreenContext(int _width, int _height)
+{
+  width = _width;
+  height = _height;
+  display = EGL_NO_DISPLAY;
+  context = EGL_NO_CONTEXT;
+  framebuffer = colourBuffer = depthBuffer = 0;
+
+  ready = createContext();
+  if (!ready)
+  {
+    cout<<">> Offscreen OpenGL context could not be created"<<endl;
+    return;
+  }
+
+  createFramebuffer();
+  initOpenGL();
+
+  cout<<"---------------------------------->> Offscreen "<<width<<"x"<<height<<" on "<<glGetString(GL_RENDERER)<<endl;
+}
+
+// a desktop OpenGL context with no window and no surface
+bool OffscreenContext::createContext()
+{
+  // the surfaceless platform needs no X or Wayland server
+  PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+    (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+  if (getPlatformDisplay != NULL)
+    display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+  if (display == EGL_NO_DISPLAY)
+    display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+  if (display == EGL_NO_DISPLAY || !eglInitialize(display, NULL, NULL))
+    return false;
+
+  EGLint configAttributes[] = {
+    EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+    EGL_NONE
+  };
+  // drawing goes into a framebuffer object, the context needs no surface
+  // and so no config if the driver has EGL_KHR_no_config_context (Mesa does)
+  EGLConfig config;
+  EGLint noOfConfigs = 0;
+  if (!eglChooseConfig(display, configAttributes, &config, 1, &noOfConfigs) || noOfConfigs == 0)
+    config = EGL_NO_CONFIG_KHR;
+
+  // the default is a compatibility context, the fixed-function calls of render() need it
+  if (!eglBindAPI(EGL_OPENGL_API))
+    return false;
+  context = eglCreateContext(display, config, EGL_NO_CONTEXT, NULL);
+  if (context == EGL_NO_CONTEXT)
+    return false;
+
+  return eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context) == EGL_TRUE;
+}
+
+// what would be the window: colour and depth, width x height
+void OffscreenContext::createFramebuffer()
+{
+  glGenRenderbuffers(1, &colourBuffer);
+  glBindRenderbuffer(GL_RENDERBUFFER, colourBuffer);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+  glGenRenderbuffers(1, &depthBuffer);
+  glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+
+  glGenFramebuffers(1, &framebuffer);
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colourBuffer);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+
+  // reads come from the same buffer the scene is drawn to
+  glDrawBuffer(GL_COLOR_ATTACHMENT0);
+  glReadBuffer(GL_COLOR_ATTACHMENT0);
+}
+
+// initOpenGL(), setupAmbientLight() and setViewport() of main.cpp
+void OffscreenContext::initOpenGL()
+{
+  glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+  glClearDepth(1.0);
+  glDepthFunc(GL_LEQUAL);
+  glEnable(GL_DEPTH_TEST);
+  glShadeModel(GL_SMOOTH);
+  glHint(GL_PERSPECTIVE_CORRECTION_HINT, GL_NICEST);
+
+  glEnable(GL_LIGHTING);
+  glLightfv(GL_LIGHT0, GL_AMBIENT, ambientLight);
+  glLightfv(GL_LIGHT0, GL_DIFFUSE, diffuseLight);
+  glEnable(GL_LIGHT0);
+  glEnable(GL_COLOR_MATERIAL);
+  glColorMaterial(GL_FRONT, GL_AMBIENT_AND_DIFFUSE);
+  glMaterialfv(GL_FRONT, GL_AMBIENT, matAmbient);
+
+  glViewport(0, 0, width, height);
+  glMatrixMode(GL_PROJECTION);
+  glLoadIdentity();
+  gluPerspective(45.0f, (GLfloat)width/(GLfloat)height, 0.1f, 5000.0f);
+  glMatrixMode(GL_MODELVIEW);
+  glLoadIdentity();
+}
+
+OffscreenContext::~OffscreenContext()
+{
+  if (framebuffer != 0)
+  {
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteRenderbuffers(1, &colourBuffer);
+    glDeleteRenderbuffers(1, &depthBuffer);
+  }
+
+  if (context != EGL_NO_CONTEXT)
+  {
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(display, context);
+  }
+  if (display != EGL_NO_DISPLAY)
+    eglTerminate(display);
+}
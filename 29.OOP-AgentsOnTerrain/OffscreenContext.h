@@ -0,0 +1,54 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ Offscreen OpenGL Context
+//
+//	main.cpp needs SDL to open a window before it can draw. Servers
+//	have no display and often no graphics card. OffscreenContext
+//	asks EGL for an OpenGL context on Mesa's surfaceless platform,
+//	which needs neither: without a GPU, Mesa rasterises on the CPU
+//	(llvmpipe, one thread per core). The scene is drawn into a
+//	framebuffer object of the given size instead of a window.
+//
+//	The OpenGL state (depth test, light, viewport and projection)
+//	is set up as main.cpp does it, so Grid, SimpleTerrain and the
+//	agents are drawn by their usual render() functions and frames
+//	look like the window would.
+//
+//	Needs libEGL (Mesa). If no context can be made, isReady() is
+//	false and nothing may be drawn.
+//
+//	##########################################################
+
+#ifndef OFFSCREENCONTEXT_H
+#define OFFSCREENCONTEXT_H
+
+#include <EGL/egl.h>
+#include "OGLUtil.h"
+
+/****************************** PROTOTYPES ******************************/
+class OffscreenContext
+{
+private:
+	EGLDisplay display;
+	EGLContext context;
+	GLuint framebuffer;
+	GLuint colourBuffer, depthBuffer;
+	int width, height;
+	bool ready;
+
+	bool createContext();
+	void createFramebuffer();
+	void initOpenGL();
+
+public:
+	OffscreenContext(int _width, int _height);
+	~OffscreenContext();
+
+	bool isReady() { return ready; }
+	int getWidth() { return width; }
+	int getHeight() { return height; }
+};
+
+#endif
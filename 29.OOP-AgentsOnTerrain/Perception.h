@@ -0,0 +1,82 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ Perception Class (what an agent can see)
+//
+//	Seeking tests every candidate nearby: is it within range, and
+//	is it in front? Done with Vector3f::distance and vRotate2D that
+//	is a square root and a cos and sin per candidate, although the
+//	agent's heading is the same for all of them.
+//
+//	A Perception keeps the heading as a basis, taken from the cos
+//	and sin the agent already has for moving (see
+//	Agent::updateHeadingBasis), and tests the range in squared
+//	distance. Seeing a target is then a few multiplies.
+//
+//	The frame is the one of vRotate2D(heading-90, agent, target):
+//	z is minus the distance of the target ahead of the agent, x is
+//	sideways. cos(heading-90) is sin(heading) and sin(heading-90)
+//	is -cos(heading), so no further cos or sin is needed.
+//
+//	##########################################################
+
+#ifndef PERCEPTION_H
+#define PERCEPTION_H
+
+#include "Vector3f.h"
+
+/****************************** PROTOTYPES ******************************/
+class Perception
+{
+private:
+	double cosA, sinA;		// of heading-90 degrees
+
+public:
+	Perception()
+	{
+		cosA = 1.0;
+		sinA = 0.0;
+	}
+
+	// look along the heading whose cos and sin are given
+	void face(double cosHeading, double sinHeading)
+	{
+		cosA = sinHeading;
+		sinA = -cosHeading;
+	}
+
+	// target seen from pos, in the frame of the heading
+	Vector3f toLocal(const Vector3f &pos, const Vector3f &target) const
+	{
+		float distX = pos.x - target.x;
+		float distZ = pos.z - target.z;
+
+		Vector3f v;
+		v.x = (distX * cosA + distZ * sinA);
+		v.z = (-distX * sinA + distZ * cosA);
+		return v;
+	}
+
+	static float distance2(const Vector3f &a, const Vector3f &b)
+	{
+		float dx = a.x - b.x;
+		float dy = a.y - b.y;
+		float dz = a.z - b.z;
+
+		return dx*dx + dy*dy + dz*dz;
+	}
+
+	// within range (range2 is range squared) and at least -fov ahead
+	bool sees(const Vector3f &pos, const Vector3f &target, float range2, float fov) const
+	{
+		if (distance2(pos, target) >= range2) return false;
+
+		float distX = pos.x - target.x;
+		float distZ = pos.z - target.z;
+		float z = (-distX * sinA + distZ * cosA);
+		return z < fov;
+	}
+};
+
+#endif
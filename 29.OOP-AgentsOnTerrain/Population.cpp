@@ -0,0 +1,210 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ Structure-of-Arrays Agent Store
+//
+//	See Population.h for the rationale
+//
+//	##########################################################
+
+#include "Population.h"
+#include <string.h>
+
+Population::Population(int _capacity)
+{
+	size = 0;
+	allocate(_capacity);
+}
+
+void Population::allocate(int _capacity)
+{
+	capacity = _capacity;
+
+	position = new Vector3f[capacity];
+
+	heading = new float[capacity];
+	angularVelocity = new float[capacity];
+	movement = new float[capacity];
+
+	basisAngle = new float[capacity];
+	cosHeading = new double[capacity];
+	sinHeading = new double[capacity];
+
+	speed = new float[capacity];
+	maxSpeed = new float[capacity];
+	maxAngle = new float[capacity];
+	friction = new float[capacity];
+
+	isForward = new unsigned char[capacity];
+	isBackward = new unsigned char[capacity];
+	isLeft = new unsigned char[capacity];
+	isRight = new unsigned char[capacity];
+}
+
+void Population::release()
+{
+	delete[] position;
+	delete[] heading; delete[] angularVelocity; delete[] movement;
+	delete[] basisAngle; delete[] cosHeading; delete[] sinHeading;
+	delete[] speed; delete[] maxSpeed; delete[] maxAngle; delete[] friction;
+	delete[] isForward; delete[] isBackward; delete[] isLeft; delete[] isRight;
+}
+
+// one array over to a longer one
+template <class T>
+static void moveOver(T *&array, int count, int capacity)
+{
+	T *longer = new T[capacity];
+	memcpy(longer, array, count * sizeof(T));
+	delete[] array;
+	array = longer;
+}
+
+void Population::reserve(int count)
+{
+	if (count <= capacity) return;
+
+	capacity = count;
+
+	moveOver(position, size, capacity);
+
+	moveOver(heading, size, capacity);
+	moveOver(angularVelocity, size, capacity);
+	moveOver(movement, size, capacity);
+
+	moveOver(basisAngle, size, capacity);
+	moveOver(cosHeading, size, capacity);
+	moveOver(sinHeading, size, capacity);
+
+	moveOver(speed, size, capacity);
+	moveOver(maxSpeed, size, capacity);
+	moveOver(maxAngle, size, capacity);
+	moveOver(friction, size, capacity);
+
+	moveOver(isForward, size, capacity);
+	moveOver(isBackward, size, capacity);
+	moveOver(isLeft, size, capacity);
+	moveOver(isRight, size, capacity);
+}
+
+// slots between the old size and this one have never been used: they
+// are cleared so that the loops leave them alone too
+void Population::use(int slot)
+{
+	while (size <= slot)
+	{
+		position[size] = Vector3f(0.0f, 0.0f, 0.0f);
+		heading[size] = 0.0f;
+		basisAngle[size] = NAN;		// nothing cached yet
+		cosHeading[size] = 1.0;
+		sinHeading[size] = 0.0;
+		speed[size] = maxSpeed[size] = maxAngle[size] = 0.0f;
+		friction[size] = 1.0f;
+		clear(size);
+		size++;
+	}
+}
+
+// no thrust and no turn: integrateMotion() does not move the slot
+void Population::clear(int slot)
+{
+	angularVelocity[slot] = 0.0f;
+	movement[slot] = 0.0f;
+	isForward[slot] = isBackward[slot] = 0;
+	isLeft[slot] = isRight[slot] = 0;
+}
+
+// 1st loop: thrust, friction and turning
+// the branches of Agent::integrate() are written as selects so that the
+// loop has no control flow and vectorises (g++ -O3). The arrays are passed
+// as __restrict parameters, there are too many of them for the compiler's
+// runtime overlap checks. -0.0001f/0.0001f are the same thresholds as the
+// double literals in Agent::integrate() for any float value.
+static void integrateThrustAndTurn(int n,
+	float * __restrict mv, float * __restrict av, float * __restrict hd,
+	const float * __restrict sp, const float * __restrict mSp,
+	const float * __restrict mAn, const float * __restrict fric,
+	unsigned char * __restrict fw, unsigned char * __restrict bw,
+	const unsigned char * __restrict lt, const unsigned char * __restrict rt)
+{
+	for(int i = 0; i < n; i++)
+	{
+		float m = mv[i];
+		float a = av[i];
+		float fr = fric[i];
+		float ms = mSp[i];
+		float ma = mAn[i];
+		unsigned char fwd = fw[i];
+		unsigned char bwd = bw[i];
+
+		// forward thrust
+		float mF = m - sp[i];
+		mF = (mF <= -ms) ? -ms : mF;
+		unsigned char stopF = (mF >= -0.0001f);
+		mF = stopF ? 0.0f : mF;
+		m = fwd ? mF : m;
+		fwd = fwd & !stopF;
+
+		// backward thrust
+		float mB = m + sp[i];
+		mB = (mB >= ms) ? ms : mB;
+		unsigned char stopB = (mB <= 0.0001f);
+		mB = stopB ? 0.0f : mB;
+		m = bwd ? mB : m;
+		bwd = bwd & !stopB;
+
+		m *= fr; // friction has to be outside to reduce the movement to a halt
+
+		// turning right
+		float aR = (a >= ma) ? ma : a;
+		aR *= fr;
+		aR = (aR <= 0.001f) ? 0.0f : aR;
+		a = rt[i] ? aR : a;
+
+		// turning left
+		float aL = (a <= -ma) ? -ma : a;
+		aL *= fr;
+		aL = (aL >= -0.001f) ? 0.0f : aL;
+		a = lt[i] ? aL : a;
+
+		mv[i] = m;
+		av[i] = a;
+		hd[i] += a;
+		fw[i] = fwd;
+		bw[i] = bwd;
+	}
+}
+
+// 2nd loop: advance along the heading
+// cos and sin are cached per slot as in Agent::updateHeadingBasis(), so
+// that the decisions of the next tick find them up to date
+static void advance(int n, Vector3f * __restrict pos,
+	const float * __restrict mv, const float * __restrict hd,
+	float * __restrict bA, double * __restrict cH, double * __restrict sH)
+{
+	for(int i = 0; i < n; i++)
+	{
+		if (hd[i] != bA[i])
+		{
+			bA[i] = hd[i];
+			cH[i] = cos(hd[i] * PI/180);
+			sH[i] = sin(hd[i] * PI/180);
+		}
+		pos[i].x -= mv[i]*cH[i];
+		pos[i].z -= mv[i]*sH[i];
+	}
+}
+
+void Population::integrateMotion()
+{
+	integrateThrustAndTurn(size, movement, angularVelocity, heading,
+		speed, maxSpeed, maxAngle, friction, isForward, isBackward, isLeft, isRight);
+
+	advance(size, position, movement, heading, basisAngle, cosHeading, sinHeading);
+}
+
+Population::~Population()
+{
+	release();
+}
@@ -0,0 +1,71 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ Structure-of-Arrays Agent Store
+//
+//	Each Agent object keeps two Matrix4x4, its senses, its links to
+//	the world and a vtable pointer. Looping over agents to move them
+//	would touch a lot of memory for a few floats each.
+//
+//	Population is where the kinematic state of a species lives: one
+//	contiguous array per variable, indexed by the agent's slot in
+//	its AgentPool. An Agent reads and writes its own entries through
+//	vPos(), fCurrAngle() and so on, nothing is copied in or out, and
+//	integrateMotion() applies the friction/turn/advance logic of
+//	Agent::integrate() to the whole species in two tight loops.
+//
+//	The loops run over slots [0, size), freed slots included. A slot
+//	is cleared when its agent dies, so that it stays where it is.
+//
+//	##########################################################
+
+#ifndef POPULATION_H
+#define POPULATION_H
+
+#include "OGLUtil.h"
+#include "Vector3f.h"
+
+/****************************** PROTOTYPES ******************************/
+class Population
+{
+private:
+	void allocate(int capacity);
+	void release();
+
+public:
+	int size;						// slots [0, size) have been used
+	int capacity;				// number of slots the arrays can hold
+
+	// position (vPos), x y z of a slot together: others read it often
+	Vector3f *position;
+
+	// heading (fCurrAngle), angular velocity (fAngle), movement (fMovement)
+	float *heading, *angularVelocity, *movement;
+
+	// cos and sin of the heading when it was basisAngle (fBasisAngle,
+	// dCosHeading, dSinHeading): integrateMotion() keeps them up to date
+	// for the decisions of the next tick
+	float *basisAngle;
+	double *cosHeading, *sinHeading;
+
+	// per agent constants of motion
+	float *speed, *maxSpeed, *maxAngle, *friction;
+
+	// movement flags, 0 or 1
+	unsigned char *isForward, *isBackward, *isLeft, *isRight;
+
+	Population(int _capacity);
+	~Population();
+
+	// room for count slots, the arrays are copied over (rare)
+	void reserve(int count);
+
+	void use(int slot);			// an agent is born in slot
+	void clear(int slot);		// the agent in slot has died
+
+	// the movement step of Agent::integrate() for every slot at once
+	void integrateMotion();
+};
+
+#endif
@@ -0,0 +1,60 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ Double-Buffered Agent Position Store
+//
+//	When agents update one after another in place, an agent that
+//	updates later in a tick sees where earlier agents have already
+//	moved to, so the result depends on the order of the loop.
+//
+//	With a PositionBuffer, agents look at each other in the front
+//	buffer, which holds everybody's position at the end of the
+//	previous tick and is not written during the tick. Each agent
+//	writes its new position to its own slot in the back buffer and
+//	the two are swapped when the whole tick is done. The order (and
+//	the number of threads) no longer changes the outcome.
+//
+//	##########################################################
+
+#ifndef POSITIONBUFFER_H
+#define POSITIONBUFFER_H
+
+#include "Vector3f.h"
+
+/****************************** PROTOTYPES ******************************/
+class PositionBuffer
+{
+private:
+	Vector3f *buffers[2];
+
+public:
+	Vector3f *front;		// read only during a tick
+	Vector3f *back;			// agent i writes back[i] only
+	int size;
+
+	PositionBuffer(int _size)
+	{
+		size = _size;
+		buffers[0] = new Vector3f[size];
+		buffers[1] = new Vector3f[size];
+		front = buffers[0];
+		back = buffers[1];
+	}
+
+	// publish the back buffer as the new snapshot
+	void swap()
+	{
+		Vector3f *temp = front;
+		front = back;
+		back = temp;
+	}
+
+	~PositionBuffer()
+	{
+		delete[] buffers[0];
+		delete[] buffers[1];
+	}
+};
+
+#endif
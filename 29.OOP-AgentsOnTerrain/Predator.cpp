@@ -22,28 +22,28 @@
 #include "OGLUtil.h"
 #include "Predator.h"
 
-Predator::Predator(int _id, float origX, float origY, float origZ, float speed): Agent(_id, origX, origY, origZ, speed)
+Predator::Predator(int _id, float origX, float origY, float origZ, float speed, Population *population, int slot): Agent(_id, origX, origY, origZ, speed, population, slot)
 {
   // setting standard movement, rotation speed
-	fAngle = 0;
-	fCurrAngle = 0;
+	fAngle() = 0;
+	fCurrAngle() = 0;
 	fAngleSpeed = 0.1f;
-	fMaxAngle = 5.0f;		// increased max angle now
-	fSpeed = speed;
-	fMaxSpeed = 0.1f;
-	fMovement = 0.0f;
-	fFriction = 0.99f;
+	fMaxAngle() = 5.0f;		// increased max angle now
+	fSpeed() = speed;
+	fMaxSpeed() = 0.1f;
+	fMovement() = 0.0f;
+	fFriction() = 0.99f;
 
 	fScale = 1.0f;
 
-	isForward = isBackward = isRight = isLeft = false;
+	isForward() = isBackward() = isRight() = isLeft() = false;
 
-	vPos.x = origX;
-	vPos.y = origY;
-	vPos.z = origZ;
+	vPos().x = origX;
+	vPos().y = origY;
+	vPos().z = origZ;
 
   // Predator VARIABLES
-  _preyID = -1; 	// started with no prey
+  _prey = NO_AGENT; 	// started with no prey
   _distanceToTarget = 20.0f;
   fov = -1.0f;		// -5.0 = 45 degree from angle FOV
 
@@ -51,7 +51,12 @@ Predator::Predator(int _id, float origX, float origY, float origZ, float speed):
 
 Predator::~Predator()
 {
-  cout<<"Predator destroyed!"<<endl;
+}
+
+void Predator::setSenses(float distance, float fieldOfView)
+{
+  _distanceToTarget = distance;
+  fov = fieldOfView;
 }
 
 // void Predator::setBoundary(float top, float bottom, float left, float right)
@@ -75,9 +80,12 @@ void Predator::render()
 		matPos.identity();
 
 		// set translation and rotation matrix
-		matPos.translate(vPos.x, vPos.y, vPos.z);
+		Vector3f pos = getRenderPosition();
+		matPos.translate(pos.x, pos.y, pos.z);
 		//fCurrAngle += 0.11f;
-		matRot.rotateY(fCurrAngle);
+		float c, s;
+		getRenderBasis(c, s);
+		matRot.rotateY(c, s);
 
 		// load position matrix and add rotation
 		//glLoadMatrixf(matPos.matrix);
@@ -91,39 +99,7 @@ void Predator::update()
 {
 	autonomy();
 
-	if(isForward)
-	{
-		fMovement -= fSpeed;
-		if (fMovement <= -fMaxSpeed) fMovement = -fMaxSpeed;
-		if (fMovement >= -0.0001) { fMovement = 0.0f; isForward = false; }
-	}
-
-	if(isBackward)
-	{
-		fMovement += fSpeed;
-		if (fMovement >= fMaxSpeed) fMovement = fMaxSpeed;
-		if (fMovement <= 0.0001) { fMovement = 0.0f; isBackward = false; }
-	}
-	fMovement *= fFriction; // friction has to be outside to reduce the movement to a halt
-
-	if(isRight)
-	{
-		if (fAngle >= fMaxAngle) fAngle = fMaxAngle;
-		fAngle *= fFriction;
-		if (fAngle <= 0.001f) fAngle = 0.0f;
-	}
-
-	if (isLeft)
-	{
-		if (fAngle <= -fMaxAngle) fAngle = -fMaxAngle;
-		fAngle *= fFriction;
-		if (fAngle >= -0.001f) fAngle = 0.0f;
-	}
-
-	fCurrAngle += fAngle;
-
-	vPos.x -= fMovement*cos(fCurrAngle * PI/180);
-	vPos.z -= fMovement*sin(fCurrAngle * PI/180);
+	integrate();
 
 	//cout<<vPos.x<< " "<<vPos.z<<" m:"<<fMovement<<endl;
 	//cout<<" isForward:"<<isForward<<" isBackward"<<isBackward<<" isLeft:"<<isLeft<<" isRight:"<<isRight<<endl;
@@ -133,12 +109,14 @@ void Predator::update()
 
 void Predator::autonomy()
 {
+	PROFILE("autonomy");
+
 	// simulating erratic behaviour by randomising decisions
 
-  if(_preyID == -1) // if no prey
+  if(resolve(PREY, _prey) == NULL) // if no prey
   {
     // generate a random boolean value
-  	int r = rand() % 2;
+  	int r = random(STREAM_TURN, 2);
 
   	if(r == 0)
   	{
@@ -150,7 +128,7 @@ void Predator::autonomy()
   	}
 
   	// get another random value for thrust
-  	r = rand() % 2;
+  	r = random(STREAM_THRUST, 2);
   	if(r == 0)
   	{
   		moveForward(2.0f);
@@ -164,7 +142,7 @@ void Predator::autonomy()
 
 
 		// check boundary and try not to leave!
-    if (_grid->isInBoundary(vPos, 2.0f) == false)
+    if (_grid->isInBoundary(vPos(), 2.0f) == false)
     {
       rotateLeft(5.0f);
     }
@@ -172,39 +150,35 @@ void Predator::autonomy()
 
 void Predator::seek()
 {
-  for(int i = 0; i < _noOfAgents; i++)
-  {
-      Vector3f p = _agents[i]->getPosition();
-      // cout<<i<<" "<<p.x<<","<<p.z<<endl;
-      if(_agents[i]->speciesType == PREY)
-        if(p.distance(vPos, p) < _distanceToTarget)
-        {
-          Vector3f visibleVec = Vector3f::vRotate2D(fCurrAngle-90, vPos, p);
-
-					// test if within viewing angle
-          if(visibleVec.z < fov)
-          {
-						// assign target ID if a prey is within eyesight
-            _preyID = i;
-            break;
-          }
-        }
-  }
+  // assign target ID if a prey is within eyesight
+  int target = findTarget(PREY, _distanceToTarget, fov);
+  if(target != -1)
+    _prey = _agents[target]->getHandle();
+}
+
+// between the two after the tick (see Statistics.h)
+float Predator::distanceToTarget()
+{
+  Agent *target = resolve(PREY, _prey);
+  if (target == NULL) return -1.0f;
+  return sqrt(Perception::distance2(vPos(), target->getPosition()));
 }
 
 void Predator::chase()
 {
-	// get the position of the prey based on the target (preyID)
-  Vector3f preyPos = _agents[_preyID]->getPosition();
+	// get the position of the prey based on the target (handle)
+  Agent *target = resolve(PREY, _prey);
+  Vector3f preyPos = positionOf(target->index);
 
-  float fx = vPos.x - preyPos.x;
-  float fz = vPos.z - preyPos.z;
+  float fx = vPos().x - preyPos.x;
+  float fz = vPos().z - preyPos.z;
 	// float fx = preyPos.x - vPos.x;
   // float fz = preyPos.z - vPos.z;
 
   //float Angle = round(atan2(fz,fx)*180/PI);
 
-  Vector3f visibleVec = Vector3f::vRotate2D(fCurrAngle-90, vPos, preyPos); // get visibility vector
+  faceHeading();
+  Vector3f visibleVec = perception.toLocal(vPos(), preyPos); // get visibility vector
 
 	//if(p.distance(vPos, p) < 15.0f)		// within distance of 15
 		if(visibleVec.z < fov)					// if within FOV
@@ -215,8 +189,9 @@ void Predator::chase()
 
 
 	// lose the prey if beyond a certain range
-  if (vPos.distance(vPos, preyPos) > _distanceToTarget + 5)
-     _preyID = -1;
+  float lost = _distanceToTarget + 5;
+  if (Perception::distance2(vPos(), preyPos) > lost * lost)
+     _prey = NO_AGENT;
 
 }
 
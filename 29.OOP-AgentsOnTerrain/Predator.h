@@ -28,21 +28,26 @@
 
 
 /****************************** PROTOTYPES ******************************/
-class Predator: public Agent
+// final: nothing derives from it, so calls through a Predator* (and on
+// this inside it) are direct calls the compiler can inline
+class Predator final: public Agent
 {
+  // checkpoints save and restore the target
+  friend class Checkpoint;
+
 private:
 
 protected:
 
-  // targeted prey
-  int _preyID;
-  int _distanceToTarget;
+  // targeted prey, NO_AGENT if none (or it has died since)
+  AgentHandle _prey;
+  float _distanceToTarget;
   float fov;
 
 public:
   // ------------------- constructors destructors
   Predator();
-  Predator(int _id, float origX, float origY, float origZ, float speed);
+  Predator(int _id, float origX, float origY, float origZ, float speed, Population *population = NULL, int slot = 0);
   ~Predator();
 
   // ------------------- update functions
@@ -53,7 +58,9 @@ public:
   void autonomy();
 
   void seek();  // look for agents in vicinity
+  void setSenses(float distance, float fieldOfView);  // how far and how wide it seeks
   void chase(); // target prey
+  float distanceToTarget();  // -1 without a target
 
 
   // ------------------- visual representation function
@@ -16,28 +16,28 @@
 #include "OGLUtil.h"
 #include "Prey.h"
 
-Prey::Prey(int _id, float origX, float origY, float origZ, float speed): Agent(_id, origX, origY, origZ, speed)
+Prey::Prey(int _id, float origX, float origY, float origZ, float speed, Population *population, int slot): Agent(_id, origX, origY, origZ, speed, population, slot)
 {
   // setting standard movement, rotation speed
-	fAngle = 0;
-	fCurrAngle = 0;
+	fAngle() = 0;
+	fCurrAngle() = 0;
 	fAngleSpeed = 0.1f;
-	fMaxAngle = 5.0f;		// increased max angle now
-	fSpeed = speed;
-	fMaxSpeed = 0.1f;
-	fMovement = 0.0f;
-	fFriction = 0.99f;
+	fMaxAngle() = 5.0f;		// increased max angle now
+	fSpeed() = speed;
+	fMaxSpeed() = 0.1f;
+	fMovement() = 0.0f;
+	fFriction() = 0.99f;
 
 	fScale = 1.0f;
 
-	isForward = isBackward = isRight = isLeft = false;
+	isForward() = isBackward() = isRight() = isLeft() = false;
 
-	vPos.x = origX;
-	vPos.y = origY;
-	vPos.z = origZ;
+	vPos().x = origX;
+	vPos().y = origY;
+	vPos().z = origZ;
 
   // Prey VARIABLES
-  _preyID = -1; 	// started with no prey
+  _prey = NO_AGENT; 	// started with no prey
   _distanceToTarget = 20.0f;
   fov = -1.0f;		// -5.0 = 45 degree from angle FOV
 
@@ -46,7 +46,12 @@ Prey::Prey(int _id, float origX, float origY, float origZ, float speed): Agent(_
 
 Prey::~Prey()
 {
-  cout<<"Prey destroyed!"<<endl;
+}
+
+void Prey::setSenses(float distance, float fieldOfView)
+{
+  _distanceToTarget = distance;
+  fov = fieldOfView;
 }
 
 // void Prey::setBoundary(float top, float bottom, float left, float right)
@@ -70,9 +75,12 @@ void Prey::render()
 		matPos.identity();
 
 		// set translation and rotation matrix
-		matPos.translate(vPos.x, vPos.y, vPos.z);
+		Vector3f pos = getRenderPosition();
+		matPos.translate(pos.x, pos.y, pos.z);
 		//fCurrAngle += 0.11f;
-		matRot.rotateY(fCurrAngle);
+		float c, s;
+		getRenderBasis(c, s);
+		matRot.rotateY(c, s);
 
 		// load position matrix and add rotation
 		//glLoadMatrixf(matPos.matrix);
@@ -86,39 +94,7 @@ void Prey::update()
 {
 	autonomy();
 
-	if(isForward)
-	{
-		fMovement -= fSpeed;
-		if (fMovement <= -fMaxSpeed) fMovement = -fMaxSpeed;
-		if (fMovement >= -0.0001) { fMovement = 0.0f; isForward = false; }
-	}
-
-	if(isBackward)
-	{
-		fMovement += fSpeed;
-		if (fMovement >= fMaxSpeed) fMovement = fMaxSpeed;
-		if (fMovement <= 0.0001) { fMovement = 0.0f; isBackward = false; }
-	}
-	fMovement *= fFriction; // friction has to be outside to reduce the movement to a halt
-
-	if(isRight)
-	{
-		if (fAngle >= fMaxAngle) fAngle = fMaxAngle;
-		fAngle *= fFriction;
-		if (fAngle <= 0.001f) fAngle = 0.0f;
-	}
-
-	if (isLeft)
-	{
-		if (fAngle <= -fMaxAngle) fAngle = -fMaxAngle;
-		fAngle *= fFriction;
-		if (fAngle >= -0.001f) fAngle = 0.0f;
-	}
-
-	fCurrAngle += fAngle;
-
-	vPos.x -= fMovement*cos(fCurrAngle * PI/180);
-	vPos.z -= fMovement*sin(fCurrAngle * PI/180);
+	integrate();
 
 	//cout<<vPos.x<< " "<<vPos.z<<" m:"<<fMovement<<endl;
 	//cout<<" isForward:"<<isForward<<" isBackward"<<isBackward<<" isLeft:"<<isLeft<<" isRight:"<<isRight<<endl;
@@ -128,12 +104,14 @@ void Prey::update()
 
 void Prey::autonomy()
 {
+	PROFILE("autonomy");
+
 	// simulating erratic behaviour by randomising decisions
 
-  if(_preyID == -1) // if no prey
+  if(resolve(SNACK, _prey) == NULL) // if no prey
   {
     // generate a random boolean value
-  	int r = rand() % 2;
+  	int r = random(STREAM_TURN, 2);
 
   	if(r == 0)
   	{
@@ -145,7 +123,7 @@ void Prey::autonomy()
   	}
 
   	// get another random value for thrust
-  	r = rand() % 2;
+  	r = random(STREAM_THRUST, 2);
   	if(r == 0)
   	{
   		moveForward(2.0f);
@@ -159,7 +137,7 @@ void Prey::autonomy()
 
 
 		// check boundary and try not to leave!
-    if (_grid->isInBoundary(vPos, 2.0f) == false)
+    if (_grid->isInBoundary(vPos(), 2.0f) == false)
     {
       rotateLeft(5.0f);
     }
@@ -167,39 +145,35 @@ void Prey::autonomy()
 
 void Prey::seek()
 {
-  for(int i = 0; i < _noOfAgents; i++)
-  {
-      Vector3f p = _agents[i]->getPosition();
-      // cout<<i<<" "<<p.x<<","<<p.z<<endl;
-      if(_agents[i]->speciesType == SNACK)
-        if(p.distance(vPos, p) < _distanceToTarget)
-        {
-          Vector3f visibleVec = Vector3f::vRotate2D(fCurrAngle-90, vPos, p);
-
-					// test if within viewing angle
-          if(visibleVec.z < fov)
-          {
-						// assign target ID if a prey is within eyesight
-            _preyID = i;
-            break;
-          }
-        }
-  }
+  // assign target ID if a snack is within eyesight
+  int target = findTarget(SNACK, _distanceToTarget, fov);
+  if(target != -1)
+    _prey = _agents[target]->getHandle();
+}
+
+// between the two after the tick (see Statistics.h)
+float Prey::distanceToTarget()
+{
+  Agent *target = resolve(SNACK, _prey);
+  if (target == NULL) return -1.0f;
+  return sqrt(Perception::distance2(vPos(), target->getPosition()));
 }
 
 void Prey::chase()
 {
-	// get the position of the prey based on the target (preyID)
-  Vector3f preyPos = _agents[_preyID]->getPosition();
+	// get the position of the prey based on the target (handle)
+  Agent *target = resolve(SNACK, _prey);
+  Vector3f preyPos = positionOf(target->index);
 
-  float fx = vPos.x - preyPos.x;
-  float fz = vPos.z - preyPos.z;
+  float fx = vPos().x - preyPos.x;
+  float fz = vPos().z - preyPos.z;
 	// float fx = preyPos.x - vPos.x;
   // float fz = preyPos.z - vPos.z;
 
   //float Angle = round(atan2(fz,fx)*180/PI);
 
-  Vector3f visibleVec = Vector3f::vRotate2D(fCurrAngle-90, vPos, preyPos); // get visibility vector
+  faceHeading();
+  Vector3f visibleVec = perception.toLocal(vPos(), preyPos); // get visibility vector
 
 	//if(p.distance(vPos, p) < 15.0f)		// within distance of 15
 		if(visibleVec.z < fov)					// if within FOV
@@ -210,11 +184,12 @@ void Prey::chase()
 
 
 	// eat the snack if within a distance
-  if (vPos.distance(vPos, preyPos) < 1.0f)
+  if (Perception::distance2(vPos(), preyPos) < 1.0f)
 	{
-			cout<<_preyID<<" eaten!"<<endl;
-			_agents[_preyID]->isEaten();
-     _preyID = -1;
+			// the snack is not ours until World says so, another prey may
+			// want it in the same tick (see World::resolveInteractions)
+			emit(INTERACTION_EAT, target->index);
+     _prey = NO_AGENT;
 	}
 
 }
@@ -22,21 +22,26 @@
 
 
 /****************************** PROTOTYPES ******************************/
-class Prey: public Agent
+// final: nothing derives from it, so calls through a Prey* (and on
+// this inside it) are direct calls the compiler can inline
+class Prey final: public Agent
 {
+  // checkpoints save and restore the target
+  friend class Checkpoint;
+
 private:
 
 protected:
 
-  // targeted prey (snack)
-  int _preyID;
-  int _distanceToTarget;
+  // targeted prey (snack), NO_AGENT if none (or it has been eaten since)
+  AgentHandle _prey;
+  float _distanceToTarget;
   float fov;
 
 public:
   // ------------------- constructors destructors
   Prey();
-  Prey(int _id, float origX, float origY, float origZ, float speed);
+  Prey(int _id, float origX, float origY, float origZ, float speed, Population *population = NULL, int slot = 0);
   ~Prey();
 
   // ------------------- update functions
@@ -47,7 +52,9 @@ public:
   void autonomy();
 
   void seek();  // look for agents in vicinity
+  void setSenses(float distance, float fieldOfView);  // how far and how wide it seeks
   void chase(); // target prey
+  float distanceToTarget();  // -1 without a target
 
 
   // ------------------- visual representation function
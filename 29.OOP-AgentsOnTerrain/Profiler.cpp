@@ -0,0 +1,185 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ Tick Profiler
+//
+//	See Profiler.h for the rationale
+//
+//	##########################################################
+
+#include <iostream>
+#include <iomanip>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include "Profiler.h"
+
+using namespace std;
+
+// the events of one thread
+struct PROFILERING
+{
+	PROFILEEVENT *events;
+	unsigned long long count;		// events ever recorded, the ring holds the last ones
+	int thread;									// 0 is the first thread that recorded
+};
+
+atomic<bool> Profiler::enabled(false);
+
+// every ring ever created, only touched when a thread records its first event
+static mutex ringsLock;
+static vector<PROFILERING*> rings;
+
+static thread_local PROFILERING *threadRing = NULL;
+
+void Profiler::setEnabled(bool state)
+{
+	enabled.store(state);
+	cout<<">> Profiler "<<(state ? "on" : "off")<<endl;
+}
+
+long long Profiler::now()
+{
+	return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Profiler::record(const char *name, long long start, long long end)
+{
+	PROFILERING *ring = threadRing;
+	if (ring == NULL)
+	{
+		ring = new PROFILERING;
+		ring->events = new PROFILEEVENT[PROFILER_RING_SIZE];
+		ring->count = 0;
+
+		unique_lock<mutex> guard(ringsLock);
+		ring->thread = rings.size();
+		rings.push_back(ring);
+		threadRing = ring;
+	}
+
+	PROFILEEVENT &event = ring->events[ring->count & (PROFILER_RING_SIZE - 1)];
+	event.name = name;
+	event.start = start;
+	event.end = end;
+	ring->count++;
+}
+
+// the events still in a ring, oldest first
+static void forEachEvent(PROFILERING *ring, void (*visit)(PROFILERING *, PROFILEEVENT &, void *), void *data)
+{
+	unsigned long long first = ring->count > PROFILER_RING_SIZE ? ring->count - PROFILER_RING_SIZE : 0;
+	for(unsigned long long e = first; e < ring->count; e++)
+		visit(ring, ring->events[e & (PROFILER_RING_SIZE - 1)], data);
+}
+
+static void collectDuration(PROFILERING *, PROFILEEVENT &event, void *data)
+{
+	map<string, vector<long long> > &phases = *(map<string, vector<long long> > *)data;
+	phases[event.name].push_back(event.end - event.start);
+}
+
+void Profiler::printSummary()
+{
+	unique_lock<mutex> guard(ringsLock);
+
+	map<string, vector<long long> > phases;
+	unsigned long long lost = 0;
+	for(size_t r = 0; r < rings.size(); r++)
+	{
+		forEachEvent(rings[r], collectDuration, &phases);
+		if (rings[r]->count > PROFILER_RING_SIZE) lost += rings[r]->count - PROFILER_RING_SIZE;
+	}
+
+	cout<<"*********************** Profile (microseconds) ***********************"<<endl;
+	cout<<left<<setw(24)<<"phase"<<right<<setw(10)<<"count"<<setw(12)<<"mean"
+		<<setw(12)<<"p50"<<setw(12)<<"p99"<<setw(12)<<"max"<<endl;
+
+	cout<<fixed<<setprecision(3);
+	for(map<string, vector<long long> >::iterator p = phases.begin(); p != phases.end(); ++p)
+	{
+		vector<long long> &d = p->second;
+		sort(d.begin(), d.end());
+
+		double total = 0;
+		for(size_t i = 0; i < d.size(); i++) total += d[i];
+
+		size_t n = d.size();
+		cout<<left<<setw(24)<<p->first<<right<<setw(10)<<n
+			<<setw(12)<<total / n / 1000.0
+			<<setw(12)<<d[(n - 1) / 2] / 1000.0
+			<<setw(12)<<d[(size_t)((n - 1) * 0.99)] / 1000.0
+			<<setw(12)<<d[n - 1] / 1000.0<<endl;
+	}
+	cout.unsetf(ios::floatfield);
+	cout<<setprecision(6);
+
+	if (lost > 0)
+		cout<<"("<<lost<<" older events were overwritten, the figures cover the most recent ones)"<<endl;
+}
+
+struct TRACEOUTPUT
+{
+	FILE *file;
+	long long origin;
+	bool first;
+};
+
+static void writeTraceEvent(PROFILERING *ring, PROFILEEVENT &event, void *data)
+{
+	TRACEOUTPUT *out = (TRACEOUTPUT *)data;
+
+	// names are string literals in the source, quotes and backslashes are
+	// the only characters that would break the JSON
+	string name;
+	for(const char *c = event.name; *c; c++)
+	{
+		if (*c == '"' || *c == '\\') name += '\\';
+		name += *c;
+	}
+
+	// complete events ("X"), timestamps in microseconds
+	fprintf(out->file, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+		out->first ? "" : ",", name.c_str(), ring->thread,
+		(event.start - out->origin) / 1000.0, (event.end - event.start) / 1000.0);
+	out->first = false;
+}
+
+static void findOrigin(PROFILERING *, PROFILEEVENT &event, void *data)
+{
+	long long &origin = *(long long *)data;
+	if (event.start < origin) origin = event.start;
+}
+
+bool Profiler::writeChromeTrace(const char *filename)
+{
+	unique_lock<mutex> guard(ringsLock);
+
+	FILE *file = fopen(filename, "w");
+	if (file == NULL)
+	{
+		cout<<">> Trace could not be written: "<<filename<<endl;
+		return false;
+	}
+
+	TRACEOUTPUT out;
+	out.file = file;
+	out.origin = 0x7fffffffffffffffLL;
+	out.first = true;
+	for(size_t r = 0; r < rings.size(); r++)
+		forEachEvent(rings[r], findOrigin, &out.origin);
+
+	fprintf(file, "{\"traceEvents\":[");
+	for(size_t r = 0; r < rings.size(); r++)
+		forEachEvent(rings[r], writeTraceEvent, &out);
+	fprintf(file, "\n]}\n");
+
+	bool ok = (fclose(file) == 0);
+	cout<<">> Trace written: "<<filename<<endl;
+	return ok;
+}
@@ -0,0 +1,92 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ Tick Profiler
+//
+//	Shows where the time of a tick or a frame goes. A phase is
+//	timed by putting PROFILE("name") at the top of a block: the
+//	ProfileScope it declares takes a nanosecond timestamp when the
+//	block starts and records (name, start, end) when it ends.
+//
+//	Every thread records into its own ring buffer, so timing the
+//	ThreadPool workers needs no locking. A ring keeps the last
+//	PROFILER_RING_SIZE events of its thread, older ones are
+//	overwritten. The profiler starts switched off, where a
+//	PROFILE() costs one load of a flag; setEnabled() turns it on
+//	and off while the program runs.
+//
+//	printSummary() prints the mean, median (p50), p99 and max of
+//	each phase, writeChromeTrace() writes the events for
+//	chrome://tracing or https://ui.perfetto.dev, one row per thread.
+//	Both read the rings of every thread, call them when no timed
+//	code is running (e.g. at exit).
+//
+//	##########################################################
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+using namespace std;
+
+#define PROFILER_RING_SIZE (1 << 18)		// events kept per thread
+
+// one timed block
+struct PROFILEEVENT
+{
+	const char *name;		// a string literal, never copied
+	long long start;		// ns
+	long long end;			// ns
+};
+
+/****************************** PROTOTYPES ******************************/
+class Profiler
+{
+private:
+	static atomic<bool> enabled;
+
+public:
+	static void setEnabled(bool state);
+	static bool isEnabled() { return enabled.load(memory_order_relaxed); }
+
+	// nanoseconds since an arbitrary epoch (steady clock)
+	static long long now();
+
+	// add an event to the ring of the calling thread
+	static void record(const char *name, long long start, long long end);
+
+	static void printSummary();
+	static bool writeChromeTrace(const char *filename);
+};
+
+// times the block it is declared in (only if the profiler is on when it starts)
+class ProfileScope
+{
+private:
+	const char *name;
+	long long start;
+
+public:
+	ProfileScope(const char *_name)
+	{
+		name = NULL;
+		start = 0;
+		if (Profiler::isEnabled())
+		{
+			name = _name;
+			start = Profiler::now();
+		}
+	}
+
+	~ProfileScope()
+	{
+		if (name != NULL) Profiler::record(name, start, Profiler::now());
+	}
+};
+
+#define PROFILE_JOIN(a, b) a##b
+#define PROFILE_NAME(line) PROFILE_JOIN(profileScope, line)
+#define PROFILE(name) ProfileScope PROFILE_NAME(__LINE__)(name)
+
+#endif
@@ -0,0 +1,99 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ Counter-Based Random Number Generator (Philox4x32-10)
+//
+//	rand() keeps one hidden state for the whole process: every call
+//	changes what the next caller gets, so the numbers an agent sees
+//	depend on who called rand() before it, and threads fight over it.
+//
+//	A counter-based generator has no state. The random number is a
+//	scrambling function of (seed, agent id, tick, stream): the same
+//	inputs always give the same number, whichever thread asks and in
+//	whatever order. Philox4x32-10 (Salmon et al., SC'11) is used,
+//	the generator behind cuRAND and Random123.
+//
+//	##########################################################
+
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <stdint.h>
+
+// one stream per call site, so that draws from different places
+// in the same tick never reuse the same random number
+enum RandomStream
+{
+	STREAM_TURN,				// autonomy(): rotate left or right
+	STREAM_THRUST,			// autonomy(): move forward or not
+	STREAM_PLACE_X,			// initial placement of agents
+	STREAM_PLACE_Z,
+	STREAM_RESPAWN_X,		// snacks re-appearing after being eaten
+	STREAM_RESPAWN_Z,
+	STREAM_TERRAIN,			// terrain heights
+	STREAM_CONFLICT			// who wins a target wanted by several agents
+};
+
+class Random
+{
+private:
+	static void mulhilo(uint32_t a, uint32_t b, uint32_t &hi, uint32_t &lo)
+	{
+		uint64_t product = (uint64_t)a * b;
+		hi = (uint32_t)(product >> 32);
+		lo = (uint32_t)product;
+	}
+
+public:
+	/******************* functions *******************/
+	// the Philox4x32 bijection with 10 rounds: 128-bit counter + 64-bit key
+	static void philox(const uint32_t counter[4], const uint32_t key[2], uint32_t out[4])
+	{
+		uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+		uint32_t k0 = key[0], k1 = key[1];
+
+		for(int round = 0; round < 10; round++)
+		{
+			uint32_t hi0, lo0, hi1, lo1;
+			mulhilo(0xD2511F53u, c0, hi0, lo0);
+			mulhilo(0xCD9E8D57u, c2, hi1, lo1);
+
+			uint32_t n0 = hi1 ^ c1 ^ k0;
+			uint32_t n2 = hi0 ^ c3 ^ k1;
+			c0 = n0; c1 = lo1; c2 = n2; c3 = lo0;
+
+			// bump the key (Weyl sequence)
+			k0 += 0x9E3779B9u;
+			k1 += 0xBB67AE85u;
+		}
+
+		out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
+	}
+
+	// 32 random bits for (seed, id, tick, stream)
+	static uint32_t bits(uint32_t seed, uint32_t id, uint64_t tick, uint32_t stream)
+	{
+		uint32_t counter[4] = { id, (uint32_t)tick, (uint32_t)(tick >> 32), stream };
+		uint32_t key[2] = { seed, 0x5EED5EEDu };
+		uint32_t out[4];
+
+		philox(counter, key, out);
+		return out[0];
+	}
+
+	// an integer in [0, n), the replacement for rand() % n
+	static int range(uint32_t seed, uint32_t id, uint64_t tick, uint32_t stream, int n)
+	{
+		// multiply-shift maps 32 bits onto [0, n) without the modulo bias
+		return (int)(((uint64_t)bits(seed, id, tick, stream) * (uint32_t)n) >> 32);
+	}
+
+	// a float in [0, 1)
+	static float uniform(uint32_t seed, uint32_t id, uint64_t tick, uint32_t stream)
+	{
+		return (bits(seed, id, tick, stream) >> 8) * (1.0f / 16777216.0f);
+	}
+};
+
+#endif
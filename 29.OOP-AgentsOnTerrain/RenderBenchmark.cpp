@@ -0,0 +1,244 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ Rendering Benchmark (opens a window)
+//
+//  Frame time of SimpleTerrain::render() at DEM sizes, drawing
+//  with glBegin/glEnd (every vertex sent every pass of every
+//  frame) against the retained mesh (vertex buffer objects
+//  uploaded once). Each frame is finished with glFinish() so the
+//  time includes the work of the graphics card.
+//
+//  Frame time of the retained mesh seen from near the ground, all
+//  of it against only the chunks in the view frustum (Frustum.h),
+//  the far ones with fewer vertices.
+//
+//  Frame time of drawing the agents of a World one render() at a
+//  time against the AgentRenderer (one instanced draw call per
+//  species), at population sizes.
+//
+//  ----------------------------------------------------------
+//  How to compile:
+//  g++ -O2 -I/usr/include/ RenderBenchmark.cpp SimpleTerrain.cpp Agent.cpp Predator.cpp Prey.cpp Snack.cpp Grid.cpp SpatialHash.cpp Population.cpp ThreadPool.cpp World.cpp AgentRenderer.cpp Profiler.cpp -o renderbenchmark -L/usr/lib -lSDL2 -lGL -lGLU -pthread
+//
+//  How to run:
+//  ./renderbenchmark          (256, 1024 and 4096 quads a side, 1000, 10000 and 100000 agents)
+//  ./renderbenchmark 512      (only the given terrain size)
+//  ./renderbenchmark 512 5000 (the given terrain size and number of agents)
+//	##########################################################
+
+#include <iostream>
+#include <stdlib.h>
+#include "OGLUtil.h"
+#include "SimpleTerrain.h"
+#include "World.h"
+#include "Timing.h"
+
+using namespace std;
+
+/****************************** PROTOTYPES ******************************/
+double timeFrames(SimpleTerrain *terrain, int frames);
+void benchmarkTerrainRender(int size);
+double timeViewFrames(SimpleTerrain *terrain, int frames, const Frustum *view);
+void benchmarkTerrainCulling(int size);
+double timeAgentFrames(World *world, int frames);
+void benchmarkAgentRender(int agents);
+
+/****************************** GLOBAL VARIABLES ******************************/
+SDL_Window* displayWindow;
+SDL_Renderer* displayRenderer;
+
+/****************************** MAIN METHOD ******************************/
+int main(int argc, char**argv)
+{
+    // a compatibility context, the terrain uses the fixed-function pipeline
+    if ( SDL_Init(SDL_INIT_VIDEO) < 0 ) {
+        cout<<"Unable to initialise SDL: "<<SDL_GetError()<<endl;
+        exit(1);
+    }
+    SDL_CreateWindowAndRenderer(800, 800, SDL_WINDOW_OPENGL, &displayWindow, &displayRenderer);
+    SDL_SetWindowTitle(displayWindow, "Terrain Render Benchmark");
+
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_LIGHT0);
+
+    glViewport(0, 0, 800, 800);
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    gluPerspective(45.0f, 1.0f, 0.1f, 5000.0f);
+    glMatrixMode(GL_MODELVIEW);
+
+    cout<<"*********************** Benchmark: terrain render ***********************"<<endl;
+    cout<<"quads\t\timmediate ms/frame\tmesh ms/frame\tupload ms\tspeedup"<<endl;
+
+    if (argc > 1)
+        benchmarkTerrainRender(atoi(argv[1]));
+    else
+    {
+        benchmarkTerrainRender(256);
+        benchmarkTerrainRender(1024);
+        benchmarkTerrainRender(4096);
+    }
+
+    cout<<"*********************** Benchmark: terrain culling ***********************"<<endl;
+    cout<<"quads\t\tmesh ms/frame\tculled ms/frame\tchunks drawn\tspeedup"<<endl;
+
+    if (argc > 1)
+        benchmarkTerrainCulling(atoi(argv[1]));
+    else
+    {
+        benchmarkTerrainCulling(1024);
+        benchmarkTerrainCulling(4096);
+    }
+
+    cout<<"*********************** Benchmark: agent render ***********************"<<endl;
+    cout<<"agents		per agent ms/frame	instanced ms/frame	speedup"<<endl;
+
+    if (argc > 2)
+        benchmarkAgentRender(atoi(argv[2]));
+    else
+    {
+        benchmarkAgentRender(1000);
+        benchmarkAgentRender(10000);
+        benchmarkAgentRender(100000);
+    }
+
+    SDL_DestroyWindow(displayWindow);
+    SDL_Quit();
+
+    return 0;
+}
+
+// average seconds per frame
+double timeFrames(SimpleTerrain *terrain, int frames)
+{
+    double t0 = secondsNow();
+    for(int f = 0; f < frames; f++)
+    {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glLoadIdentity();
+        gluLookAt(0.0f, 700.0f, 700.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+
+        terrain->render();
+
+        glFinish();
+        SDL_GL_SwapWindow(displayWindow);
+    }
+    return (secondsNow() - t0) / frames;
+}
+
+// the terrain always covers 1000 x 1000 units, as in Benchmark.cpp
+void benchmarkTerrainRender(int size)
+{
+    SimpleTerrain *terrain = new SimpleTerrain(size, size, 1.0f, 1000.0f / size);
+
+    // fewer frames for the big terrains, immediate mode takes seconds each
+    int frames = size <= 256 ? 60 : (size <= 1024 ? 10 : 2);
+
+    terrain->setRetainedMesh(false);
+    double immediate = timeFrames(terrain, frames);
+
+    // the first frame with the mesh uploads it
+    terrain->setRetainedMesh(true);
+    double upload = timeFrames(terrain, 1);
+    double mesh = timeFrames(terrain, frames);
+
+    cout<<size<<"x"<<size<<"\t"<<(size < 1000 ? "\t" : "")<<immediate*1e3<<"\t\t\t"<<mesh*1e3
+        <<"\t\t"<<(upload - mesh)*1e3<<"\t\t"<<immediate/mesh<<"x"<<endl;
+
+    delete terrain;
+}
+
+// average seconds per frame, from near the ground looking across the terrain
+double timeViewFrames(SimpleTerrain *terrain, int frames, const Frustum *view)
+{
+    double t0 = secondsNow();
+    for(int f = 0; f < frames; f++)
+    {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glLoadIdentity();
+        gluLookAt(0.0f, 30.0f, 450.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+
+        terrain->render(view);
+
+        glFinish();
+        SDL_GL_SwapWindow(displayWindow);
+    }
+    return (secondsNow() - t0) / frames;
+}
+
+// the same view with and without the frustum
+void benchmarkTerrainCulling(int size)
+{
+    SimpleTerrain *terrain = new SimpleTerrain(size, size, 1.0f, 1000.0f / size);
+    terrain->setRetainedMesh(true);
+
+    Frustum view;
+    view.set(Vector3f(0.0f, 30.0f, 450.0f), Vector3f(0.0f, 0.0f, 0.0f), Vector3f(0.0f, 1.0f, 0.0f), 45.0f, 1.0f, 0.1f, 5000.0f);
+
+    int frames = size <= 1024 ? 30 : 10;
+
+    timeViewFrames(terrain, 1, NULL);   // uploads the mesh and builds the chunks
+    double mesh = timeViewFrames(terrain, frames, NULL);
+    timeViewFrames(terrain, 1, &view);
+    double culled = timeViewFrames(terrain, frames, &view);
+
+    cout<<size<<"x"<<size<<"\t"<<(size < 1000 ? "\t" : "")<<mesh*1e3<<"\t\t"<<culled*1e3
+        <<"\t\t"<<terrain->getVisibleChunks()<<"/"<<terrain->getNoOfChunks()<<"\t\t"<<mesh/culled<<"x"<<endl;
+
+    delete terrain;
+}
+
+// average seconds per frame, only the agents are drawn
+double timeAgentFrames(World *world, int frames)
+{
+    double t0 = secondsNow();
+    for(int f = 0; f < frames; f++)
+    {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glLoadIdentity();
+        gluLookAt(0.0f, 150.0f, 150.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+
+        if (world->instancedAgents)
+        {
+            world->agentRenderer->draw(PREDATOR, world->agents, world->noOfPredators);
+            world->agentRenderer->draw(PREY, world->agents + world->noOfPredators, world->noOfPreys);
+            world->agentRenderer->draw(SNACK, world->agents + world->noOfPredators + world->noOfPreys, world->noOfSnacks);
+        }
+        else
+            for(int i = 0; i < world->agentNo; i++)
+                world->agents[i]->render();
+
+        glFinish();
+        SDL_GL_SwapWindow(displayWindow);
+    }
+    return (secondsNow() - t0) / frames;
+}
+
+// a third of each species, spread over the 100 x 100 grid of main.cpp
+void benchmarkAgentRender(int agents)
+{
+    World *world = new World(agents / 3, agents / 3, agents - 2 * (agents / 3));
+    world->agentRenderer = new AgentRenderer();
+    if (!world->agentRenderer->isReady())
+    {
+        cout<<agents<<"\t\tno instanced drawing in this OpenGL context"<<endl;
+        delete world;
+        return;
+    }
+
+    int frames = agents <= 10000 ? 30 : 5;
+
+    world->setInstancedAgents(false);
+    double perAgent = timeAgentFrames(world, frames);
+
+    world->setInstancedAgents(true);
+    timeAgentFrames(world, 1);      // the first frame builds the instance buffers
+    double instanced = timeAgentFrames(world, frames);
+
+    cout<<agents<<"\t\t"<<perAgent*1e3<<"\t\t\t"<<instanced*1e3<<"\t\t\t"<<perAgent/instanced<<"x"<<endl;
+
+    delete world;
+}
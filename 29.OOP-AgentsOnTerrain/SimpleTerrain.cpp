@@ -10,13 +10,61 @@
 //
 //	##########################################################
 
+#include <string.h>
 #include "SimpleTerrain.h"
 using namespace std;
 
-SimpleTerrain::SimpleTerrain(int width, int height, float _scaleHeight, float terrainSize)
+SimpleTerrain::SimpleTerrain(int width, int height, float _scaleHeight, float terrainSize, unsigned int seed)
 {
-  cout<<"---------------------------------->> Creating Simple 4x4 Terrain"<<endl;
+  cout<<"---------------------------------->> Creating Simple "<<width<<"x"<<height<<" Terrain"<<endl;
 
+  allocate(width, height, _scaleHeight, terrainSize);
+
+  // random height threshold of terrain
+  int max = 20;
+  int min = 0;
+
+  // initialising the heightfield
+  for(int x = 0; x<width+1; x++)    // row x axis
+	{
+		for(int z = 0; z<height+1; z++) // column z axis
+		{
+      // randomise the height, the vertex index is the random number id
+      float pointHeight = Random::range(seed, x*(height+1)+z, 0, STREAM_TERRAIN, max)-min;
+      heightField[index(x, z)] = pointHeight*scaleHeight;
+		}
+	}
+
+  _flag = NORMAL_SMOOTH;
+
+  findHeightRange();
+  calculateNormals(NORMAL_FLAT);
+  calculatePlanes();
+
+  // only small terrains are worth reading on the console
+  if (dWidth <= 8 && dHeight <= 8)
+    printTerrainData();
+}
+
+// a terrain with known heights (e.g. from a checkpoint), in the tiled
+// layout of heightField, noOfPoints values
+SimpleTerrain::SimpleTerrain(int width, int height, float _scaleHeight, float terrainSize, const float *heights)
+{
+  cout<<"---------------------------------->> Loading Simple "<<width<<"x"<<height<<" Terrain"<<endl;
+
+  allocate(width, height, _scaleHeight, terrainSize);
+  memcpy(heightField, heights, noOfPoints * sizeof(float));
+
+  _flag = NORMAL_SMOOTH;
+
+  // normals and planes follow from the heights
+  findHeightRange();
+  calculateNormals(NORMAL_FLAT);
+  calculatePlanes();
+}
+
+void SimpleTerrain::allocate(int width, int height, float _scaleHeight, float terrainSize)
+{
   // width and height of terrain (also vertex grids)
 	dWidth = width;
 	dHeight = height;
@@ -30,33 +78,55 @@ SimpleTerrain::SimpleTerrain(int width, int height, float _scaleHeight, float te
 
 	// set terrain boundary
 	boundary.top = -adjFromOrig;
-	boundary.bottom = adjFromOrig;
+	boundary.bottom = dHeight*terrainScale - adjFromOrig;
 	boundary.left = -adjFromOrig;
 	boundary.right = adjFromOrig;
 
-  // random height threshold of terrain
-  int max = 20;
-  int min = 0;
+	// (width+1) x (height+1) vertices, rounded up to whole tiles
+	tilesX = (width + TERRAIN_TILE) / TERRAIN_TILE;
+	tilesZ = (height + TERRAIN_TILE) / TERRAIN_TILE;
+	noOfPoints = (long)tilesX * tilesZ * TERRAIN_TILE * TERRAIN_TILE;
+
+	heightField = new float[noOfPoints];
+	terrainNormals = new Vector3f[noOfPoints];
+	planes = new TERRAINPLANE[2 * noOfPoints];
+
+	// nothing edited yet
+	tileFlags = new unsigned char[tilesX * tilesZ];
+	memset(tileFlags, 0, tilesX * tilesZ);
+	_normalFlag = NORMAL_FLAT;
+
+	// the GPU mesh is built by the first render() (there may be no OpenGL context yet)
+	retainedMesh = true;
+	meshDirty = true;
+	meshOnCard = false;
+	vertexBuffer = 0;
+	indexBuffer = 0;
+	meshIndices = 0;
+
+	// chunks too, by the first render() with a view
+	chunks = NULL;
+	chunksX = (width + TERRAIN_CHUNK - 1) / TERRAIN_CHUNK;
+	chunksZ = (height + TERRAIN_CHUNK - 1) / TERRAIN_CHUNK;
+	chunkIndexBuffer = 0;
+}
 
-  // initialising 2D array with 0 vectors
-  for(int x = 0; x<width+1; x++)    // row x axis
-	{
-		for(int z = 0; z<height+1; z++) // column z axis
+void SimpleTerrain::findHeightRange()
+{
+	minHeight = maxHeight = heightField[index(0, 0)];
+	for(int x = 0; x <= dWidth; x++)
+		for(int z = 0; z <= dHeight; z++)
 		{
-      float pointHeight = (rand()%max)-min; // randomise the height
-      terrainData[x][z] = Vector3f(	x*terrainScale - adjFromOrig,
-									pointHeight*scaleHeight,	// random height
-									z*terrainScale - adjFromOrig
-								);
+			float h = heightField[index(x, z)];
+			if (h < minHeight) minHeight = h;
+			if (h > maxHeight) maxHeight = h;
 		}
-	}
-
-  _flag = NORMAL_SMOOTH;
-
-  calculateCellBoundary();
-  calculateNormals(NORMAL_FLAT);
+}
 
-  printTerrainData();
+void SimpleTerrain::getHeightRange(float &lowest, float &highest)
+{
+	lowest = minHeight;
+	highest = maxHeight;
 }
 
 void SimpleTerrain::printTerrainData() // print out the file
@@ -68,13 +138,13 @@ void SimpleTerrain::printTerrainData() // print out the file
 	{
 		for(int z=0; z<dHeight; z++)	// z
 		{
-				cout<<"["<<terrainData[x][z].x<<","<<terrainData[x][z].y<<","<<terrainData[x][z].z<<"]";
+				cout<<"["<<terrainData(x, z).x<<","<<terrainData(x, z).y<<","<<terrainData(x, z).z<<"]";
 		}
 		cout<<" \n"<<endl;
 	}
 }
 
-void SimpleTerrain::render()
+void SimpleTerrain::render(const Frustum *view)
 {
   glLineWidth(0.1f);
 	glEnable(GL_TEXTURE_2D);
@@ -112,8 +182,62 @@ void SimpleTerrain::render()
 	glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, SpecularMaterial);
 	glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS, mShininess);
 
+  // the tiles refresh() published go to the card first, then the chunks
+  // in view are picked once for both passes
+  if (retainedMesh)
+  {
+    updateMesh();
+    if (view != NULL) selectChunks(*view);
+  }
+
   glColor3f(1.0f, 1.0f, 1.0f);		// set colour
   glPolygonMode(GL_FRONT, GL_FILL);
+  drawSurface(view);
+
+  glColor3f(0.0f, 0.0f, 0.0f);		// set colour
+  glLineWidth(0.5f);
+  glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+  drawSurface(view);
+}
+
+// one pass over the terrain surface, render() draws it filled and as a wireframe
+void SimpleTerrain::drawSurface(const Frustum *view)
+{
+  if (!retainedMesh)
+    drawImmediate();
+  else if (view != NULL)
+    drawChunks();
+  else
+    drawMesh();
+}
+
+// the buffers on the card follow edited heights: the tiles published by
+// refresh() become this thread's and are uploaded without the lock
+void SimpleTerrain::updateMesh()
+{
+  {
+    lock_guard<mutex> guard(meshLock);
+    if (meshDirty)
+    {
+      buildMesh();
+      publishedTiles.clear();		// the new mesh has them already
+    }
+    uploads.swap(publishedTiles);
+  }
+
+  for(size_t t=0; t<uploads.size(); t++)
+  {
+    uploadTile(uploads[t]);
+    if (chunks != NULL) widenChunks(uploads[t]);
+  }
+  uploads.clear();
+}
+
+// every vertex sent again through glNormal3f/glVertex3f, every pass of every frame
+void SimpleTerrain::drawImmediate()
+{
+  lock_guard<mutex> guard(meshLock);
+
   for(int x=0; x<dWidth; x++)
   {
     // this needs to be in the first loop so that the 'strip' is drawn properly
@@ -121,80 +245,338 @@ void SimpleTerrain::render()
     for(int z=0; z<dHeight; z++)
     {
         // vertex 0
-        glNormal3f(terrainNormals[x][z].x, terrainNormals[x][z].y, terrainNormals[x][z].z);
-        glVertex3f(terrainData[x][z].x, terrainData[x][z].y, terrainData[x][z].z);
+        glNormal3f(normal(x, z).x, normal(x, z).y, normal(x, z).z);
+        glVertex3f(terrainData(x, z).x, terrainData(x, z).y, terrainData(x, z).z);
 
         // vertex 1
-        glNormal3f(terrainNormals[x][z+1].x, terrainNormals[x][z+1].y, terrainNormals[x][z+1].z);
-        glVertex3f(terrainData[x][z+1].x, terrainData[x][z+1].y, terrainData[x][z+1].z);
+        glNormal3f(normal(x, z+1).x, normal(x, z+1).y, normal(x, z+1).z);
+        glVertex3f(terrainData(x, z+1).x, terrainData(x, z+1).y, terrainData(x, z+1).z);
 
         // vertex 2
-        glNormal3f(terrainNormals[x+1][z].x, terrainNormals[x+1][z].y, terrainNormals[x+1][z].z);
-        glVertex3f(terrainData[x+1][z].x, terrainData[x+1][z].y, terrainData[x+1][z].z);
+        glNormal3f(normal(x+1, z).x, normal(x+1, z).y, normal(x+1, z).z);
+        glVertex3f(terrainData(x+1, z).x, terrainData(x+1, z).y, terrainData(x+1, z).z);
 
         // vertex 3
-        glNormal3f(terrainNormals[x+1][z+1].x, terrainNormals[x+1][z+1].y, terrainNormals[x+1][z+1].z);
-        glVertex3f(terrainData[x+1][z+1].x, terrainData[x+1][z+1].y, terrainData[x+1][z+1].z);
+        glNormal3f(normal(x+1, z+1).x, normal(x+1, z+1).y, normal(x+1, z+1).z);
+        glVertex3f(terrainData(x+1, z+1).x, terrainData(x+1, z+1).y, terrainData(x+1, z+1).z);
     }
     glEnd();  // ending the strip after the creation of each row
 
   }
+}
 
-  glColor3f(0.0f, 0.0f, 0.0f);		// set colour
-  glLineWidth(0.5f);
-  glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+// the mesh lives in buffers on the graphics card: one vertex buffer
+// (position and normal of every vertex) and one index buffer that walks
+// the rows as triangle strips, stitched into a single strip by repeating
+// the last index of a row and the first of the next (zero-area triangles)
+void SimpleTerrain::buildMesh()
+{
+  int vertices = (dWidth+1) * (dHeight+1);
+  meshIndices = 1 + dWidth * 2 * (dHeight+1) + 2 * (dWidth-1);
+
+  if (vertexBuffer == 0) glGenBuffers(1, &vertexBuffer);
+  if (indexBuffer == 0) glGenBuffers(1, &indexBuffer);
+
+  // ------------------------------------------ vertices: x, y, z, nx, ny, nz
+  glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+  glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)vertices * 6 * sizeof(GLfloat), NULL, GL_STATIC_DRAW);
+  GLfloat *v = (GLfloat *)glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
+  for(int x=0; x<=dWidth; x++)
+    for(int z=0; z<=dHeight; z++)
+    {
+      Vector3f p = terrainData(x, z);
+      Vector3f &n = normal(x, z);
+      *v++ = p.x; *v++ = p.y; *v++ = p.z;
+      *v++ = n.x; *v++ = n.y; *v++ = n.z;
+    }
+  glUnmapBuffer(GL_ARRAY_BUFFER);
+
+  // ------------------------------------------ indices, the same triangles as the planes:
+  // (x,z) (x+1,z) (x,z+1) then (x+1,z) (x,z+1) (x+1,z+1)
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)meshIndices * sizeof(GLuint), NULL, GL_STATIC_DRAW);
+  GLuint *i = (GLuint *)glMapBuffer(GL_ELEMENT_ARRAY_BUFFER, GL_WRITE_ONLY);
+
+  // the extra first index flips the winding to that of the glBegin strips,
+  // so the same faces are front faces (render() fills only GL_FRONT)
+  *i++ = 0;
   for(int x=0; x<dWidth; x++)
   {
-    // this needs to be in the first loop so that the 'strip' is drawn properly
-    glBegin(GL_TRIANGLE_STRIP);
-    for(int z=0; z<dHeight; z++)
+    if (x > 0) *i++ = x * (dHeight+1);    // repeat the first of this row
+    for(int z=0; z<=dHeight; z++)
     {
-        // vertex 0
-        glNormal3f(terrainNormals[x][z].x, terrainNormals[x][z].y, terrainNormals[x][z].z);
-        glVertex3f(terrainData[x][z].x, terrainData[x][z].y, terrainData[x][z].z);
+      *i++ = x * (dHeight+1) + z;
+      *i++ = (x+1) * (dHeight+1) + z;
+    }
+    if (x < dWidth-1) *i++ = (x+1) * (dHeight+1) + dHeight;   // repeat the last of this row
+  }
+  glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
 
-        // vertex 1
-        glNormal3f(terrainNormals[x][z+1].x, terrainNormals[x][z+1].y, terrainNormals[x][z+1].z);
-        glVertex3f(terrainData[x][z+1].x, terrainData[x][z+1].y, terrainData[x][z+1].z);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
-        // vertex 2
-        glNormal3f(terrainNormals[x+1][z].x, terrainNormals[x+1][z].y, terrainNormals[x+1][z].z);
-        glVertex3f(terrainData[x+1][z].x, terrainData[x+1][z].y, terrainData[x+1][z].z);
+  // the heights may have changed since the boxes were fitted
+  if (chunks != NULL)
+    for(int c=0; c<chunksX * chunksZ; c++)
+      fitChunk(c);
 
-        // vertex 3
-        glNormal3f(terrainNormals[x+1][z+1].x, terrainNormals[x+1][z+1].y, terrainNormals[x+1][z+1].z);
-        glVertex3f(terrainData[x+1][z+1].x, terrainData[x+1][z+1].y, terrainData[x+1][z+1].z);
+  meshDirty = false;
+  meshOnCard = true;
+}
+
+// a copy of the vertices of one refreshed tile for the drawing thread
+// (called by refresh(), holding meshLock)
+void SimpleTerrain::publishTile(int tile)
+{
+  int x0 = (tile / tilesZ) * TERRAIN_TILE;
+  int z0 = (tile % tilesZ) * TERRAIN_TILE;
+  int x1 = (x0 + TERRAIN_TILE - 1 < dWidth) ? x0 + TERRAIN_TILE - 1 : dWidth;
+  int z1 = (z0 + TERRAIN_TILE - 1 < dHeight) ? z0 + TERRAIN_TILE - 1 : dHeight;
+
+  publishedTiles.push_back(TILEUPLOAD());
+  TILEUPLOAD &upload = publishedTiles.back();
+  upload.tile = tile;
+  upload.lowest = upload.highest = heightField[index(x0, z0)];
+  upload.vertices.reserve((x1 - x0 + 1) * (z1 - z0 + 1) * 6);
+
+  for(int x=x0; x<=x1; x++)
+    for(int z=z0; z<=z1; z++)
+    {
+      Vector3f p = terrainData(x, z);
+      Vector3f &n = normal(x, z);
+      upload.vertices.push_back(p.x); upload.vertices.push_back(p.y); upload.vertices.push_back(p.z);
+      upload.vertices.push_back(n.x); upload.vertices.push_back(n.y); upload.vertices.push_back(n.z);
+      if (p.y < upload.lowest) upload.lowest = p.y;
+      if (p.y > upload.highest) upload.highest = p.y;
     }
-    glEnd();  // ending the strip after the creation of each row
+}
+
+// the vertices of one refreshed tile, a row of the tile (along z) is
+// contiguous in the vertex buffer
+void SimpleTerrain::uploadTile(const TILEUPLOAD &upload)
+{
+  int x0 = (upload.tile / tilesZ) * TERRAIN_TILE;
+  int z0 = (upload.tile % tilesZ) * TERRAIN_TILE;
+  int x1 = (x0 + TERRAIN_TILE - 1 < dWidth) ? x0 + TERRAIN_TILE - 1 : dWidth;
+  int z1 = (z0 + TERRAIN_TILE - 1 < dHeight) ? z0 + TERRAIN_TILE - 1 : dHeight;
+  int rowLength = (z1 - z0 + 1) * 6;
+
+  glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+  for(int x=x0; x<=x1; x++)
+  {
+    GLintptr offset = ((GLintptr)x * (dHeight+1) + z0) * 6 * sizeof(GLfloat);
+    glBufferSubData(GL_ARRAY_BUFFER, offset, rowLength * sizeof(GLfloat), &upload.vertices[(x - x0) * rowLength]);
+  }
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// the bounding boxes of the chunk the tile is in and of those sharing its
+// first row or column of vertices take in its heights; they only grow
+// (still safe to cull with) until the mesh is built again
+void SimpleTerrain::widenChunks(const TILEUPLOAD &upload)
+{
+  int x = (upload.tile / tilesZ) * TERRAIN_TILE;
+  int z = (upload.tile % tilesZ) * TERRAIN_TILE;
+  int cx1 = (x < dWidth ? x : dWidth - 1) / TERRAIN_CHUNK;
+  int cz1 = (z < dHeight ? z : dHeight - 1) / TERRAIN_CHUNK;
+  int cx0 = (x > 0 ? x - 1 : 0) / TERRAIN_CHUNK;
+  int cz0 = (z > 0 ? z - 1 : 0) / TERRAIN_CHUNK;
+  for(int cx=cx0; cx<=cx1; cx++)
+    for(int cz=cz0; cz<=cz1; cz++)
+    {
+      BOUNDINGBOX &box = chunks[cx * chunksZ + cz].box;
+      if (upload.lowest < box.minY) box.minY = upload.lowest;
+      if (upload.highest > box.maxY) box.maxY = upload.highest;
+    }
+}
+
+void SimpleTerrain::drawMesh()
+{
+  glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_NORMAL_ARRAY);
+  glVertexPointer(3, GL_FLOAT, 6 * sizeof(GLfloat), (const GLvoid *)0);
+  glNormalPointer(GL_FLOAT, 6 * sizeof(GLfloat), (const GLvoid *)(3 * sizeof(GLfloat)));
+
+  glDrawElements(GL_TRIANGLE_STRIP, meshIndices, GL_UNSIGNED_INT, (const GLvoid *)0);
+
+  glDisableClientState(GL_NORMAL_ARRAY);
+  glDisableClientState(GL_VERTEX_ARRAY);
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+// ------------------------------------------ chunks: culling and level of detail
+
+// vertices from first to last every step, the last one always included
+static int chunkSteps(int first, int last, int step, int *out)
+{
+  int n = 0;
+  for(int v = first; v < last; v += step)
+    out[n++] = v;
+  out[n++] = last;
+  return n;
+}
+
+// every chunk at every level as its own strip, walked like buildMesh()
+// walks the whole terrain, into one index buffer
+void SimpleTerrain::buildChunks()
+{
+  int noOfChunks = chunksX * chunksZ;
+  chunks = new TERRAINCHUNK[noOfChunks];
+
+  vector<GLuint> indices;
+  int xs[TERRAIN_CHUNK + 1], zs[TERRAIN_CHUNK + 1];
+
+  for(int cx=0; cx<chunksX; cx++)
+    for(int cz=0; cz<chunksZ; cz++)
+    {
+      TERRAINCHUNK &chunk = chunks[cx * chunksZ + cz];
+      int x0 = cx * TERRAIN_CHUNK;
+      int z0 = cz * TERRAIN_CHUNK;
+      int x1 = (x0 + TERRAIN_CHUNK < dWidth) ? x0 + TERRAIN_CHUNK : dWidth;
+      int z1 = (z0 + TERRAIN_CHUNK < dHeight) ? z0 + TERRAIN_CHUNK : dHeight;
+
+      for(int lod=0; lod<TERRAIN_LODS; lod++)
+      {
+        int step = 1 << lod;
+        int noOfX = chunkSteps(x0, x1, step, xs);
+        int noOfZ = chunkSteps(z0, z1, step, zs);
+
+        chunk.first[lod] = indices.size();
+
+        // the extra first index gives the strip the winding of buildMesh()
+        indices.push_back(xs[0] * (dHeight+1) + zs[0]);
+        for(int i=0; i<noOfX-1; i++)
+        {
+          if (i > 0) indices.push_back(xs[i] * (dHeight+1) + zs[0]);
+          for(int j=0; j<noOfZ; j++)
+          {
+            indices.push_back(xs[i] * (dHeight+1) + zs[j]);
+            indices.push_back(xs[i+1] * (dHeight+1) + zs[j]);
+          }
+          if (i < noOfX-2) indices.push_back(xs[i+1] * (dHeight+1) + zs[noOfZ-1]);
+        }
+
+        chunk.count[lod] = indices.size() - chunk.first[lod];
+      }
+
+      fitChunk(cx * chunksZ + cz);
+    }
+
+  glGenBuffers(1, &chunkIndexBuffer);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, chunkIndexBuffer);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)indices.size() * sizeof(GLuint), &indices[0], GL_STATIC_DRAW);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
 
+// the bounding box of a chunk around its vertices
+void SimpleTerrain::fitChunk(int chunk)
+{
+  int x0 = (chunk / chunksZ) * TERRAIN_CHUNK;
+  int z0 = (chunk % chunksZ) * TERRAIN_CHUNK;
+  int x1 = (x0 + TERRAIN_CHUNK < dWidth) ? x0 + TERRAIN_CHUNK : dWidth;
+  int z1 = (z0 + TERRAIN_CHUNK < dHeight) ? z0 + TERRAIN_CHUNK : dHeight;
+
+  BOUNDINGBOX &box = chunks[chunk].box;
+  box.minX = x0 * terrainScale - adjFromOrig;
+  box.maxX = x1 * terrainScale - adjFromOrig;
+  box.minZ = z0 * terrainScale - adjFromOrig;
+  box.maxZ = z1 * terrainScale - adjFromOrig;
+
+  box.minY = box.maxY = heightField[index(x0, z0)];
+  for(int x=x0; x<=x1; x++)
+    for(int z=z0; z<=z1; z++)
+    {
+      float h = heightField[index(x, z)];
+      if (h < box.minY) box.minY = h;
+      if (h > box.maxY) box.maxY = h;
+    }
+}
+
+// the strips of the chunks in view, each at the level its distance asks for
+void SimpleTerrain::selectChunks(const Frustum &view)
+{
+  if (chunks == NULL)
+  {
+    lock_guard<mutex> guard(meshLock);		// fitChunk() reads the heights
+    buildChunks();
   }
 
+  drawCounts.clear();
+  drawOffsets.clear();
+
+  float fullDetail = TERRAIN_LOD_DISTANCE * terrainScale;
+  for(int c=0; c<chunksX * chunksZ; c++)
+  {
+    if (!view.sees(chunks[c].box)) continue;
+
+    int lod = 0;
+    float distance = view.distance(chunks[c].box);
+    for(float limit = fullDetail; lod < TERRAIN_LODS-1 && distance > limit; limit *= 2.0f)
+      lod++;
+
+    drawCounts.push_back(chunks[c].count[lod]);
+    drawOffsets.push_back((const GLvoid *)(chunks[c].first[lod] * sizeof(GLuint)));
+  }
+}
+
+// the chunks picked by selectChunks(), in one call
+void SimpleTerrain::drawChunks()
+{
+  if (drawCounts.empty()) return;
+
+  glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, chunkIndexBuffer);
+
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_NORMAL_ARRAY);
+  glVertexPointer(3, GL_FLOAT, 6 * sizeof(GLfloat), (const GLvoid *)0);
+  glNormalPointer(GL_FLOAT, 6 * sizeof(GLfloat), (const GLvoid *)(3 * sizeof(GLfloat)));
+
+  glMultiDrawElements(GL_TRIANGLE_STRIP, &drawCounts[0], GL_UNSIGNED_INT, &drawOffsets[0], drawCounts.size());
+
+  glDisableClientState(GL_NORMAL_ARRAY);
+  glDisableClientState(GL_VERTEX_ARRAY);
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
-// this calculates each cell's boundary (each cell is made up of 4 vertices)
+void SimpleTerrain::setRetainedMesh(bool state)
+{
+  retainedMesh = state;
+
+  // drawn without the buffers, nothing is published until they are built again
+  if (!state)
+  {
+    lock_guard<mutex> guard(meshLock);
+    meshOnCard = false;
+    meshDirty = true;
+    publishedTiles.clear();
+  }
+}
+
+// this calculates a cell's boundary (each cell is made up of 4 vertices)
 // the rationale for this is so that we can determine which 3 vertices to calculate the normals
 // for getting the height map of the terrain
-void SimpleTerrain::calculateCellBoundary()
+// (computed when asked, a table for a 4096 x 4096 terrain would take 256MB)
+CELLINFO SimpleTerrain::getCellInfo(int x, int z)
 {
-	cout<<">> Calculating cell boundary..."<<endl;
+	CELLINFO cell;
 
-	for(int x=0; x<dWidth; x++)								// x
-	{
-		//cout<<"----  x :: "<<x<<"---------------"<<endl;
-		for(int z=0; z<dHeight; z++)								// z
-		{
-			cellinfo[x][z].top = z * terrainScale - adjFromOrig;         // top
-			cellinfo[x][z].bottom = (z+1) * terrainScale - adjFromOrig;  // bottom
-			cellinfo[x][z].left = x * terrainScale - adjFromOrig;			   // left
-			cellinfo[x][z].right = (x+1) * terrainScale - adjFromOrig;   // right
-
-			//cout<<"z:"<<z<<"    top:"<<cellinfo[x][z].top<<" bottom:"<<cellinfo[x][z].bottom<<" left:"<<cellinfo[x][z].left<<" right:"<<cellinfo[x][z].right<<endl;
-		}
-	}
+	cell.top = z * terrainScale - adjFromOrig;         // top
+	cell.bottom = (z+1) * terrainScale - adjFromOrig;  // bottom
+	cell.left = x * terrainScale - adjFromOrig;			   // left
+	cell.right = (x+1) * terrainScale - adjFromOrig;   // right
 
+	return cell;
 }
 
-float SimpleTerrain::getHeight(Vector3f pos)
+float SimpleTerrain::getHeight(Vector3f pos) const
 {
 	float terrainHeight = 0.0f;
 
@@ -223,71 +605,80 @@ float SimpleTerrain::getHeight(Vector3f pos)
 
 void SimpleTerrain::posToArrayIndex(Vector3f &pos, int &inX, int &inZ)
 {
-	// precalculate the halfWidth and halfHeight
-	float halfWidth = dWidth/2;
-	float halfHeight = dHeight/2;
-
 	// dereference inX and inZ
-	// convert the position to the index of the terrainData[x][z]
-	// "pos.x/adjFromOrig" is the ratio of the pos in relation to the terrain.
-	inX = floor((pos.x/adjFromOrig) * halfWidth + halfWidth);
-	inZ = floor((pos.z/adjFromOrig) * halfHeight + halfHeight);
+	// convert the position to the index of the cell [x][z]
+	// "pos.x + adjFromOrig" is the distance from the terrain's left edge
+	inX = floor((pos.x + adjFromOrig) / terrainScale);
+	inZ = floor((pos.z + adjFromOrig) / terrainScale);
+
+	// positions off the terrain use the nearest edge cell
+	if (inX < 0) inX = 0;
+	if (inX > dWidth-1) inX = dWidth-1;
+	if (inZ < 0) inZ = 0;
+	if (inZ > dHeight-1) inZ = dHeight-1;
 }
 
-bool SimpleTerrain::withinBoundary(Vector3f pos, CELLINFO bounds)
+bool SimpleTerrain::withinBoundary(Vector3f pos, CELLINFO bounds) const
 {
 	if ((pos.x > bounds.left) && (pos.x < bounds.right))
 		if ((pos.z > bounds.top) && (pos.z < bounds.bottom))
 			return true;
-		else
-			return false;
+
+	return false;
 }
 
-float SimpleTerrain::distanceToPlane(Vector3f pos)
+// heights for a whole population at once, out[i] is the height under (x[i], z[i])
+// (with i counted in strides)
+void SimpleTerrain::sampleHeights(const float *x, const float *z, float *out, int n, int stride) const
 {
-	// plane equation = ax + by + cz + d = 0
-	float dist = 0.0f;
-
-	// get the normals of the plane where pos is
-	// this requires conversion of posToArrayIndex
-	int inX;
-	int inZ;
-  Vector3f faceNormal;
-
-	posToArrayIndex(pos, inX, inZ);
-	//cout<<"CELL["<<inX<<"]["<<inZ<<"] T:"<<cellinfo[inX][inZ].top<<" B:"<<cellinfo[inX][inZ].bottom<<" L:"<<cellinfo[inX][inZ].left<<" R:"<<cellinfo[inX][inZ].right<<endl;
-  
-  // // which triangle on a plane is the pos on?
-  bool isAbove = Vector3f::isAboveLine(
-    Vector3f(terrainData[inX][inZ+1].x, terrainData[inX][inZ+1].y, terrainData[inX][inZ+1].z),
-    Vector3f(terrainData[inX+1][inZ].x, terrainData[inX+1][inZ].y, terrainData[inX+1][inZ].z),
-    pos);
-
-  float D;
-  if(isAbove) // top triangle
-  {
-	  // calculate the normals for the top pair of triangle
-    faceNormal = calculateFaceNormal(terrainData[inX][inZ], terrainData[inX][inZ+1], terrainData[inX+1][inZ]);
+	// every sample's triangle first: arithmetic on x and z only
+	static thread_local vector<int> cells;
+	cells.resize(n);
+	for(int i = 0; i < n; i++)
+		cells[i] = planeIndex(x[i*stride], z[i*stride]);
+
+	// the planes fit in the cache, reading them in any order is as good
+	if ((long)noOfPoints * 2 * sizeof(TERRAINPLANE) <= TERRAIN_BATCH_GROUPING)
+	{
+		for(int i = 0; i < n; i++)
+		{
+			const TERRAINPLANE &p = planes[cells[i]];
+			out[i*stride] = (p.d - p.a * x[i*stride] - p.c * z[i*stride]) / p.b;
+		}
+		return;
+	}
 
-    // dot product of plane normal and plane position
-  	D = faceNormal.dotProduct(terrainData[inX][inZ]);
-    //faceNormal.print();
-  }
-  else  // bottom triangle
-  {
-    faceNormal = calculateFaceNormal(terrainData[inX+1][inZ+1], terrainData[inX+1][inZ], terrainData[inX][inZ+1]);
-    //faceNormal = calculateFaceNormal(terrainData[inX+1][inZ], terrainData[inX][inZ+1], terrainData[inX+1][inZ+1]);
+	// counting sort of the samples by tile, then each tile's planes are
+	// read together (a tile's planes are contiguous, see index())
+	const int planeShift = 2 * TERRAIN_TILE_SHIFT + 1;
+	int noOfTiles = tilesX * tilesZ;
+	static thread_local vector<int> starts;
+	static thread_local vector<int> order;
+	starts.assign(noOfTiles + 1, 0);
+	order.resize(n);
+
+	for(int i = 0; i < n; i++)
+		starts[(cells[i] >> planeShift) + 1]++;
+	for(int t = 0; t < noOfTiles; t++)
+		starts[t + 1] += starts[t];
+	for(int i = 0; i < n; i++)
+		order[starts[cells[i] >> planeShift]++] = i;
+
+	for(int k = 0; k < n; k++)
+	{
+		int i = order[k];
+		const TERRAINPLANE &p = planes[cells[i]];
+		out[i*stride] = (p.d - p.a * x[i*stride] - p.c * z[i*stride]) / p.b;
+	}
+}
 
-    // dot product of plane normal and plane position
-  	D = faceNormal.dotProduct(terrainData[inX+1][inZ+1]);
-  }
-	//cout<<"D of plane:"<<D<<endl;
+float SimpleTerrain::distanceToPlane(Vector3f pos) const
+{
+	// plane equation = ax + by + cz - d = 0, precomputed by calculatePlanes()
+	const TERRAINPLANE &p = planeAt(pos.x, pos.z);
 
 	// test the pos against the plane normals
-	dist = faceNormal.dotProduct(pos) - D;
-	//cout<<"The cube in relation to the plane is:"<<dist<<endl;
-
-	return  dist;
+	return p.a * pos.x + p.b * pos.y + p.c * pos.z - p.d;
 }
 
 Vector3f SimpleTerrain::calculateFaceNormal(Vector3f p0, Vector3f p1, Vector3f p2)
@@ -308,253 +699,204 @@ Vector3f SimpleTerrain::calculateFaceNormal(Vector3f p0, Vector3f p1, Vector3f p
 	return vN;
 }
 
-void SimpleTerrain::calculateNormals(int flag)
+// the normal of quad [x][z] from its x line and z line (points down, as
+// FLAT shading has always used it)
+Vector3f SimpleTerrain::cellNormal(int x, int z)
 {
-	Vector3f vN;	// the normal vector for each vertex
+	// get the 3 points for computing the 2 vectors
+	Vector3f p0 = terrainData(x, z);			// original point
+	Vector3f p1 = terrainData(x+1, z);	// the x line
+	Vector3f p2 = terrainData(x, z+1);	// the z line
 
-	if(flag == NORMAL_FLAT)
-	{
-		cout<<">> Calculating Terrain Normals: FLAT..."<<endl;
-
-		// loop through all vertices
-		for(int x=0; x<dWidth; x++)		// x
-		{
-			for(int z=0; z<dWidth; z++)	// z
-			{
-				// get the 3 points for computing the 2 vectors
-				Vector3f p0 = Vector3f(terrainData[x][z].x, terrainData[x][z].y, terrainData[x][z].z);			// original point
-				Vector3f p1 = Vector3f(terrainData[x+1][z].x, terrainData[x+1][z].y, terrainData[x+1][z].z);	// the x line
-				Vector3f p2 = Vector3f(terrainData[x][z+1].x, terrainData[x][z+1].y, terrainData[x][z+1].z);	// the z line
-
-				// compute the 2 vectors
-				Vector3f vA = p1 - p0;	// x line vector
-				Vector3f vB = p2 - p0;	// z line vector
+	// compute the 2 vectors
+	Vector3f vA = p1 - p0;	// x line vector
+	Vector3f vB = p2 - p0;	// z line vector
 
-				// get the crossproduct of the two vectors vA and vB
-				vN = vA.crossProduct(vB);
+	// get the crossproduct of the two vectors vA and vB
+	Vector3f vN = vA.crossProduct(vB);
 
-				// normalise the vector vN
-				vN.normalise();
+	// normalise the vector vN
+	vN.normalise();
 
-				//cout<<"vN:"<<vN.x<<" "<<vN.y<<" "<<vN.z<<endl;
+	return vN;
+}
 
-				// assign the normal to terrainNormal array
-				terrainNormals[x][z] = vN;
-			}
-		}
-	}
-	else if (flag == NORMAL_SMOOTH)
+Vector3f SimpleTerrain::calculateVertexNormal(int x, int z, int flag)
+{
+	if(flag == NORMAL_FLAT)
 	{
-		/**** Calculate Average of 4 quad normals for the vertex ****/
-		cout<<">> Calculating Terrain Normals: SMOOTH..."<<endl;
-
-
-		// loop through all vertices
-		for(int x=0; x < dWidth; x++)			// x
-		{
-			for(int z=0; z<dHeight; z++)		// z
-			{
-				Vector3f pOr = Vector3f(terrainData[x][z].x, terrainData[x][z].y, terrainData[x][z].z);			// original point
-
-				if ((x==0) && (z==0))	// origin (upper left)
-				{
-					// only East and South Point is computed
-					//cout<<"Origin: x="<<x<<" z="<<z<<endl;
-
-					Vector3f pE = Vector3f(terrainData[x+1][z].x, terrainData[x+1][z].y, terrainData[x+1][z].z);		// east point
-					Vector3f pS = Vector3f(terrainData[x][z+1].x, terrainData[x][z+1].y, terrainData[x][z+1].z);		// south point
-
-					// compute the 2 vectors
-					Vector3f vE =	pE - pOr;	// east vector
-					Vector3f vS = pS - pOr;	// south vector
-
-					// get the crossproduct of the two vectors vE and vS
-					vN = vE.crossProduct(vS);
-
-					// normalise the vector vN
-					vN.normalise();
+		// the quad that starts at this vertex (the last row and column
+		// of vertices borrow the quad before them)
+		int cx = (x < dWidth) ? x : dWidth-1;
+		int cz = (z < dHeight) ? z : dHeight-1;
 
-					//cout<<"vN:"<<vN.x<<" "<<vN.y<<" "<<vN.z<<endl;
-
-					// assign the normal to terrainNormal array
-					terrainNormals[x][z] = -vN;
-
-				}
-				else if((x==0) && (z==dHeight))	// bottom left
-				{
-					// only North and East Point
-					//cout<<"Bottom Left: x="<<x<<" z="<<z<<endl;
-
-					Vector3f pN = Vector3f(terrainData[x][z-1].x, terrainData[x][z-1].y, terrainData[x][z-1].z);		// north point
-					Vector3f pE = Vector3f(terrainData[x+1][z].x, terrainData[x+1][z].y, terrainData[x+1][z].z);		// east point
-
-					// compute the 2 vectors
-					Vector3f vE =	pE - pOr;		// east vector
-					Vector3f vNr = pN - pOr;		// north vector
-
-					// get the crossproduct of the two vectors vE and vS
-					vN = vE.crossProduct(vNr);
-
-					// normalise the vector vN
-					vN.normalise();
-
-					// assign the normal to terrainNormal array
-					terrainNormals[x][z] = -vN;
-
-				}
-				else if((x==dWidth) && (z==0))	// upper right
-				{
-					// only compute west and south vector
-					//cout<<"Upper Right: x="<<x<<" z="<<z<<endl;
-
-					Vector3f pS = Vector3f(terrainData[x][z+1].x, terrainData[x][z+1].y, terrainData[x][z+1].z);		// south point
-					Vector3f pW = Vector3f(terrainData[x-1][z].x, terrainData[x-1][z].y, terrainData[x-1][z].z);		// east point
-
-					// compute the 2 vectors
-					Vector3f vW = pW - pOr;	// west vector
-					Vector3f vS = pS - pOr;		// south vector
-
-					// get the crossproduct of the two vectors vE and vS
-					vN = vW.crossProduct(vS);
-
-					// normalise the vector vN
-					vN.normalise();
-
-					// assign the normal to terrainNormal array
-					terrainNormals[x][z] = -vN;
-
-				}
-				else	if((x==dWidth) && (z==dHeight))	// bottom right
-				{
-					// only the north and west vector
-					//cout<<"Bottom Right: x="<<x<<" z="<<z<<endl;
-
-					Vector3f pN = Vector3f(terrainData[x][z-1].x, terrainData[x][z-1].y, terrainData[x][z-1].z);		// north point
-					Vector3f pW = Vector3f(terrainData[x-1][z].x, terrainData[x-1][z].y, terrainData[x-1][z].z);		// east point
-
-					// compute the 2 vectors
-					Vector3f vNr = pN - pOr;	// north vector
-					Vector3f vW = pW - pOr;	// west vector
-
-					// get the crossproduct of the two vectors vE and vS
-					vN = vNr.crossProduct(vW);
+		return cellNormal(cx, cz);
+	}
 
-					// normalise the vector vN
-					vN.normalise();
+	/**** Calculate Average of the (up to 4) quad normals around the vertex ****/
+	// corners have 1 quad, edges have 2 and all centre vertices have 4
+	Vector3f vN;
+	for(int cx = x-1; cx <= x; cx++)
+		for(int cz = z-1; cz <= z; cz++)
+			if (cx >= 0 && cx < dWidth && cz >= 0 && cz < dHeight)
+				vN = vN + cellNormal(cx, cz);
 
-					// assign the normal to terrainNormal array
-					terrainNormals[x][z] = -vN;
-				}
-				else if ( (x==0) && ( (z>0) && (z<dHeight) ) )	// left cell span
-				{
-					// only north, south, NE, east
-					//cout<<"Left Cell Span: x="<<x<<" z="<<z<<endl;
+	// normalise the sum
+	vN.normalise();
 
-					// NE quadrant
-					Vector3f pN = Vector3f(terrainData[x][z-1].x, terrainData[x][z-1].y, terrainData[x][z-1].z);			// north point
-					Vector3f pNE = Vector3f(terrainData[x+1][z-1].x, terrainData[x+1][z-1].y, terrainData[x+1][z-1].z);	// NE point
+	// the vertex average normal points up
+	return -vN;
+}
 
-					Vector3f vTR = pNE - pN;	// top to the right vector (A - B is B points to A)
-					Vector3f vTB = pOr - pN;	// top to the bottom vector
+void SimpleTerrain::calculateNormals(int flag)
+{
+	if(flag == NORMAL_FLAT)
+		cout<<">> Calculating Terrain Normals: FLAT..."<<endl;
+	else if (flag == NORMAL_SMOOTH)
+		cout<<">> Calculating Terrain Normals: SMOOTH..."<<endl;
 
-					Vector3f vNENorm = vTR.crossProduct(vTB);
+	_normalFlag = flag;
+	lock_guard<mutex> guard(meshLock);
 
-					// SE quadrant
-					Vector3f pS = Vector3f(terrainData[x][z+1].x, terrainData[x][z+1].y, terrainData[x][z+1].z);	// south point
-					Vector3f pE = Vector3f(terrainData[x+1][z].x, terrainData[x+1][z].y, terrainData[x+1][z].z);	// east point
+	// loop through all vertices
+	for(int x=0; x <= dWidth; x++)			// x
+		for(int z=0; z <= dHeight; z++)		// z
+			normal(x, z) = calculateVertexNormal(x, z, flag);
 
-					Vector3f vOR = pE - pOr;	// origin to right vector
-					Vector3f vOB = pS - pOr;	// origin to bottom vector
+	// the GPU copy of the normals is out of date
+	meshDirty = true;
 
-					Vector3f vSENorm = vOR.crossProduct(vOB);
+	cout<<">> Terrain Normals calculated successfully"<<endl;
+}
 
-					// sum the vector
-					vN = vSENorm + vNENorm;
+// the plane of both triangles of every cell, the top one has the
+// corner [x][z], the bottom one the corner [x+1][z+1]
+void SimpleTerrain::calculatePlanes()
+{
+	cout<<">> Calculating Terrain Planes..."<<endl;
 
-					// normalise the two vectors
-					vN.normalise();
+	for(int x=0; x < dWidth; x++)			// x
+		for(int z=0; z < dHeight; z++)		// z
+			calculateCellPlanes(x, z);
+}
 
-					// the vertex average normal is then assigned to the terrainNormals
-					terrainNormals[x][z] = -vN;
+void SimpleTerrain::calculateCellPlanes(int x, int z)
+{
+	Vector3f p00 = terrainData(x, z);
+	Vector3f p01 = terrainData(x, z+1);
+	Vector3f p10 = terrainData(x+1, z);
+	Vector3f p11 = terrainData(x+1, z+1);
+
+	Vector3f top = calculateFaceNormal(p00, p01, p10);
+	Vector3f bottom = calculateFaceNormal(p11, p10, p01);
+
+	TERRAINPLANE *cell = &planes[2 * index(x, z)];
+	cell[0].a = top.x; cell[0].b = top.y; cell[0].c = top.z;
+	cell[0].d = top.dotProduct(p00);
+	cell[1].a = bottom.x; cell[1].b = bottom.y; cell[1].c = bottom.z;
+	cell[1].d = bottom.dotProduct(p11);
+}
 
-				}
-				else if ( (x==dWidth-1) && ( (z>0) && (z<dHeight) ) )	// **right cell span
-				{
-					//cout<<"Right Cell Span: x="<<x<<" z="<<z<<endl;
-				}
-				else if ( (z==0) && ( (x>0) && (x<dWidth) ) )	// top cell span
-				{
-					//cout<<"Top Cell Span: x="<<x<<" z="<<z<<endl;
-				}
-				else if ( (z==dHeight-1) && ( (x>0) && (x<dWidth) ) )	// **bottom cell span
-				{
-					//cout<<"Bottom Cell Span: x="<<x<<" z="<<z<<endl;
-				}
-				else	// all centre cells
-				{
-					//cout<<"Centre Cells: x="<<x<<" z="<<z<<endl;
-					pOr = Vector3f(terrainData[x][z].x, terrainData[x][z].y, terrainData[x][z].z);			// original point
-					Vector3f pN = Vector3f(terrainData[x][z-1].x, terrainData[x][z-1].y, terrainData[x][z-1].z);			// north point
-					Vector3f pNE = Vector3f(terrainData[x+1][z].x, terrainData[x+1][z-1].y, terrainData[x+1][z-1].z);	// NE point
-					Vector3f pE = Vector3f(terrainData[x+1][z].x, terrainData[x+1][z].y, terrainData[x+1][z].z);		// east point
-					Vector3f pS = Vector3f(terrainData[x][z+1].x, terrainData[x][z+1].y, terrainData[x][z+1].z);		// south point
-					Vector3f pSW = Vector3f(terrainData[x-1][z+1].x, terrainData[x-1][z+1].y, terrainData[x-1][z+1].z);	// southwest point
-					Vector3f pW = Vector3f(terrainData[x-1][z].x, terrainData[x-1][z].y, terrainData[x-1][z].z);			// west point
+// ------------------------------------------ editing heights
 
-					// NE quadrant
-					Vector3f vO_N = pN - pOr;	// origin to northvector
-					Vector3f vO_E = pE - pOr;	// origin to east vector
+void SimpleTerrain::setHeight(int x, int z, float height)
+{
+	if (x < 0 || x > dWidth || z < 0 || z > dHeight) return;
 
-					Vector3f vNENorm = vO_N.crossProduct(vO_E);
-					vNENorm.normalise();
+	lock_guard<mutex> guard(meshLock);
+	heightField[index(x, z)] = height;
+	if (height < minHeight) minHeight = height;
+	if (height > maxHeight) maxHeight = height;
+	markDirty(x, z);
+}
 
-					// NW quadrant
-					Vector3f vO_W = pW - pOr;	// origin to west vector
-
-					Vector3f vNWNorm = vO_W.crossProduct(vO_N);
-					vNWNorm.normalise();
+void SimpleTerrain::deform(float x, float z, float radius, float amount)
+{
+	if (radius <= 0.0f) return;
+
+	// the vertices in the square around the circle
+	int x0 = (int)ceil((x - radius + adjFromOrig) / terrainScale);
+	int x1 = (int)floor((x + radius + adjFromOrig) / terrainScale);
+	int z0 = (int)ceil((z - radius + adjFromOrig) / terrainScale);
+	int z1 = (int)floor((z + radius + adjFromOrig) / terrainScale);
+	if (x0 < 0) x0 = 0;
+	if (z0 < 0) z0 = 0;
+	if (x1 > dWidth) x1 = dWidth;
+	if (z1 > dHeight) z1 = dHeight;
+
+	lock_guard<mutex> guard(meshLock);
+	for(int vx = x0; vx <= x1; vx++)
+		for(int vz = z0; vz <= z1; vz++)
+		{
+			float dx = vx * terrainScale - adjFromOrig - x;
+			float dz = vz * terrainScale - adjFromOrig - z;
+			float d = sqrt(dx*dx + dz*dz);
+			if (d >= radius) continue;
+
+			float &h = heightField[index(vx, vz)];
+			h += amount * (1.0f - d / radius);
+			if (h < minHeight) minHeight = h;
+			if (h > maxHeight) maxHeight = h;
+			markDirty(vx, vz);
+		}
+}
 
-					// SE quadrant
-					Vector3f vO_S = pS - pOr;	// origin to south vector
+// a vertex's height moves the normals of the vertices around it (the
+// quads they average take it in) and the planes of the quads it is a
+// corner of, which all lie within one vertex of it
+void SimpleTerrain::markDirty(int x, int z)
+{
+	for(int vx = x-1; vx <= x+1; vx++)
+		for(int vz = z-1; vz <= z+1; vz++)
+		{
+			if (vx < 0 || vx > dWidth || vz < 0 || vz > dHeight) continue;
 
-					Vector3f vSENorm = vO_S.crossProduct(vO_E);
-					vSENorm.normalise();
+			int tile = (vx >> TERRAIN_TILE_SHIFT) * tilesZ + (vz >> TERRAIN_TILE_SHIFT);
+			if (!(tileFlags[tile] & TILE_DIRTY)) dirtyTiles.push_back(tile);
+			tileFlags[tile] |= TILE_DIRTY;
+		}
+}
 
-					// SW quadrant
-					Vector3f vSWNorm = vO_S.crossProduct(vO_W);
-					vSWNorm.normalise();
-
-					// sum the vector
-					vN = vNENorm + vNWNorm + vSENorm +  vSWNorm;
-
-					//vNENorm.printVector();
-					//vNWNorm.printVector();
-					//vSENorm.printVector();
-					//vSWNorm.printVector();
+// normals of the vertices and planes of the quads starting in the tile
+void SimpleTerrain::refreshTile(int tile)
+{
+	int x0 = (tile / tilesZ) * TERRAIN_TILE;
+	int z0 = (tile % tilesZ) * TERRAIN_TILE;
+	int x1 = (x0 + TERRAIN_TILE - 1 < dWidth) ? x0 + TERRAIN_TILE - 1 : dWidth;
+	int z1 = (z0 + TERRAIN_TILE - 1 < dHeight) ? z0 + TERRAIN_TILE - 1 : dHeight;
 
-					//cout<<"vN of all:";
-					//vN.printVector();
-
-					// normalise the two vectors
-					vN.normalise();
-
-					//cout<<"vN Normalised:";
-					//vN.printVector();
-
-					// the vertex average normal is then assigned to the terrainNormals
-					terrainNormals[x][z] = -vN;
-				}
-
-			}
+	for(int x = x0; x <= x1; x++)
+		for(int z = z0; z <= z1; z++)
+		{
+			normal(x, z) = calculateVertexNormal(x, z, _normalFlag);
+			if (x < dWidth && z < dHeight) calculateCellPlanes(x, z);
 		}
+}
 
-		cout<<">> Terrain Normals calculated successfully"<<endl;
-
+// on the thread that edits; the drawing thread uploads what is published
+void SimpleTerrain::refresh()
+{
+	lock_guard<mutex> guard(meshLock);
+	for(size_t t = 0; t < dirtyTiles.size(); t++)
+	{
+		refreshTile(dirtyTiles[t]);
+		tileFlags[dirtyTiles[t]] &= ~TILE_DIRTY;
+		if (meshOnCard) publishTile(dirtyTiles[t]);
 	}
-
+	dirtyTiles.clear();
 }
 
 SimpleTerrain::~SimpleTerrain()
 {
+  // only if render() has built them, i.e. there is an OpenGL context
+  if (vertexBuffer != 0) glDeleteBuffers(1, &vertexBuffer);
+  if (indexBuffer != 0) glDeleteBuffers(1, &indexBuffer);
+  if (chunkIndexBuffer != 0) glDeleteBuffers(1, &chunkIndexBuffer);
+
+  delete[] chunks;
+  delete[] tileFlags;
+  delete[] planes;
+  delete[] heightField;
+  delete[] terrainNormals;
   cout<<"Simple Terrain Destroyed"<<endl;
 }
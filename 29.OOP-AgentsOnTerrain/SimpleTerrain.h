@@ -4,10 +4,50 @@
 //	----------------------------------------------------------
 //	A C++ Object Oriented Class Integrating OpenGL
 //
-//  A simple terrain using 2D arrays to represent a small terrain
+//  A simple terrain using a heightfield to represent a terrain
 //	described by GL_TRIANGLE_STRIP and normals for lighting and
 //	the calculation of an agent skirting on the surface of each face
 //
+//	The heightfield is allocated for the size given to the
+//	constructor, from the original 4 x 4 up to 4096 x 4096 DEMs
+//
+//	The plane of every triangle is worked out once when the terrain
+//	is built, so finding the height under an agent (sampleHeight)
+//	costs a few multiplications instead of a cross product and a
+//	square root every tick
+//
+//	render() uploads the vertices, normals and triangle strip indices
+//	to the graphics card once (vertex buffer objects) and draws both
+//	the filled and the wireframe pass from them, instead of sending
+//	every vertex again with glVertex3f twice a frame
+//
+//	Heights can change while the simulation runs (setHeight(),
+//	deform()). An edit marks the tiles around the vertex dirty;
+//	the normals and planes of dirty tiles are recalculated by
+//	refresh() (World::update() calls it before the agents move), and
+//	only their part of the vertex buffer is uploaded again before the
+//	next draw, so an edit costs in proportion to the area it touches.
+//	Height queries only read: they never refresh, so any number of
+//	threads may query at once, and they see an edit after refresh()
+//
+//	The drawing may run on a thread of its own (main.cpp). It never
+//	refreshes and does not read tiles as they change: refresh() copies
+//	the vertices of the tiles it recalculated into a list (a
+//	TILEUPLOAD each) that the next render() takes over and uploads.
+//	What the drawing reads whole (building the mesh and the chunk
+//	boxes, immediate mode) it reads under meshLock, which the edits
+//	and refresh() hold too
+//
+//	render(view) draws only what the camera can see: the terrain is
+//	cut into chunks of TERRAIN_CHUNK x TERRAIN_CHUNK quads, each with
+//	a bounding box, and chunks outside the view Frustum are skipped.
+//	A chunk further away is drawn from every 2nd, 4th ... vertex
+//	(a coarser level of detail, one level per doubling of distance
+//	beyond TERRAIN_LOD_DISTANCE quads). All levels index the same
+//	vertex buffer. Where neighbouring chunks differ in level their
+//	edges do not quite meet, the gaps are far from the eye and a
+//	fraction of a pixel wide
+//
 //	The calculation of normals for TRIANGLE is used for GL_TRIANGLE_STRIP
 //	therefore, minor error exists when agents skirt on the surface
 //
@@ -16,7 +56,11 @@
 #ifndef SIMPLETERRAIN_H
 #define SIMPLETERRAIN_H
 
+#include <vector>
+#include <mutex>
 #include "OGLUtil.h"
+#include "Random.h"
+#include "Frustum.h"
 
 struct CELLINFO
 {
@@ -28,16 +72,63 @@ struct CELLINFO
 
 enum { NORMAL_FLAT, NORMAL_SMOOTH };
 
+// plane of one triangle: a*x + b*y + c*z = d, (a, b, c) is the unit
+// face normal (pointing up, so b is never 0 on a heightfield)
+struct TERRAINPLANE
+{
+	float a, b, c, d;
+};
+
+// heights and normals are stored in square tiles of TERRAIN_TILE x TERRAIN_TILE
+// vertices (row-major inside a tile, tiles row-major), so that the four
+// corners of a cell and the cells around an agent share cache lines
+#define TERRAIN_TILE_SHIFT 4
+#define TERRAIN_TILE (1 << TERRAIN_TILE_SHIFT)
+
+// sampleHeights() goes through the samples tile by tile when the planes
+// are more than this many bytes (they no longer stay in the cache)
+#define TERRAIN_BATCH_GROUPING (4 << 20)
+
+#define TILE_DIRTY 1
+
+// chunks are drawn or culled as a whole, and each has TERRAIN_LODS
+// levels of detail: every vertex, every 2nd, 4th, 8th and 16th
+#define TERRAIN_CHUNK 64
+#define TERRAIN_LODS 5
+#define TERRAIN_LOD_DISTANCE 128		// quads from the eye at full detail
+
+// the vertices of one refreshed tile for the vertex buffer, copied by
+// refresh() and uploaded by render(), rows along z as the buffer has them
+struct TILEUPLOAD
+{
+	int tile;
+	float lowest, highest;			// of its heights, for the chunk boxes
+	vector<GLfloat> vertices;		// x, y, z, nx, ny, nz per vertex
+};
+
+struct TERRAINCHUNK
+{
+	BOUNDINGBOX box;
+	int first[TERRAIN_LODS];		// of its strip in chunkIndexBuffer, per level
+	int count[TERRAIN_LODS];		// indices in the strip
+};
+
 class SimpleTerrain
 {
+  // checkpoints save the heightField as it is laid out in memory
+  friend class Checkpoint;
+
 private:
-	// 4 x 4 terrain, producing 16 quads and 32 triangles
+	// width x height quads, each made of 2 triangles
+	// (width+1) x (height+1) vertices, allocated for any size
 	// -----------------------------------------------------------------------------
-	float heightField[5][5];       // the size of the heightfield[x][y]
-	Vector3f terrainNormals[5][5];   // the terrain normals for each point
-  Vector3f terrainData[5][5];      // terrain data
+	float *heightField;				// the height of each vertex (already scaled)
+	float minHeight, maxHeight;		// lowest and highest (edits only widen them)
+	Vector3f *terrainNormals;	// the terrain normals for each point
+	TERRAINPLANE *planes;			// 2 triangles per cell: [0] top (x,z side), [1] bottom
+	int tilesZ;								// number of tiles along z (tile row length)
+	long noOfPoints;					// size of the tiled arrays (more than the vertices)
 
-	CELLINFO cellinfo[5][5];		// each polygon (quad) is a cell (this is its boundary)
 	CELLINFO boundary;			// boundary of the entire terrain (2D bounding box)
 
 	float scaleHeight;				// height scaling factor of terrain
@@ -48,22 +139,151 @@ private:
   // int qWidth, qHeight;
 
 	int _flag; // NORMAL_SMOOTH or NORMAL_FLAT normals and shading
+	int _normalFlag;	// how the normals were last calculated
+
+	// tiles whose heights were edited: normals and planes are out of date
+	// (TILE_DIRTY)
+	int tilesX;
+	unsigned char *tileFlags;
+	vector<int> dirtyTiles;
+
+	// between the simulation and the drawing thread: the heights and
+	// normals while they change or are read whole, meshDirty, meshOnCard
+	// and publishedTiles are only touched holding meshLock
+	mutex meshLock;
+	bool meshOnCard;									// the vertex buffer is built and drawn from
+	vector<TILEUPLOAD> publishedTiles;	// refreshed since the last render()
+	vector<TILEUPLOAD> uploads;					// the drawing thread's, being uploaded
+
+	void findHeightRange();
+	void markDirty(int x, int z);
+	void refreshTile(int tile);
+	void calculateCellPlanes(int x, int z);
+	void publishTile(int tile);
+	void uploadTile(const TILEUPLOAD &upload);
+	void widenChunks(const TILEUPLOAD &upload);
+
+	// retained mesh: vertices and indices stay on the graphics card and are
+	// only uploaded again when the heights or normals change
+	bool retainedMesh;				// false draws with glBegin/glEnd as before
+	bool meshDirty;						// the buffers do not match the heights
+	GLuint vertexBuffer;
+	GLuint indexBuffer;
+	int meshIndices;
+
+	void drawSurface(const Frustum *view);
+	void drawImmediate();
+	void buildMesh();
+	void updateMesh();
+	void drawMesh();
+
+	// chunks with their bounding boxes and levels of detail, built by the
+	// first render() with a view
+	TERRAINCHUNK *chunks;
+	int chunksX, chunksZ;
+	GLuint chunkIndexBuffer;
+	vector<GLsizei> drawCounts;				// strips of the chunks in view
+	vector<const GLvoid *> drawOffsets;
+
+	void buildChunks();
+	void fitChunk(int chunk);
+	void selectChunks(const Frustum &view);
+	void drawChunks();
+
+	void allocate(int width, int height, float _scaleHeight, float terrainSize);
+
+	// position of vertex [x][z] in the tiled arrays
+	int index(int x, int z) const
+	{
+		int tile = (x >> TERRAIN_TILE_SHIFT) * tilesZ + (z >> TERRAIN_TILE_SHIFT);
+		return (tile << (2 * TERRAIN_TILE_SHIFT))
+			+ ((x & (TERRAIN_TILE - 1)) << TERRAIN_TILE_SHIFT) + (z & (TERRAIN_TILE - 1));
+	}
 
 public:
   SimpleTerrain();
-	SimpleTerrain(int width, int height, float _scaleHeight, float terrainSize);
+	SimpleTerrain(int width, int height, float _scaleHeight, float terrainSize, unsigned int seed = 1);
+	SimpleTerrain(int width, int height, float _scaleHeight, float terrainSize, const float *heights);
 	~SimpleTerrain();
 
+	// vertex [x][z] of the terrain (what terrainData[x][z] used to hold)
+	Vector3f terrainData(int x, int z)
+	{
+		return Vector3f(x*terrainScale - adjFromOrig, heightField[index(x, z)], z*terrainScale - adjFromOrig);
+	}
+	Vector3f &normal(int x, int z) { return terrainNormals[index(x, z)]; }
+
+	// the triangle under (x, z): the cell, then which side of the diagonal
+	// running from [x][z+1] to [x+1][z] (the same test as isAboveLine)
+	const TERRAINPLANE &planeAt(float x, float z) const
+	{
+		return planes[planeIndex(x, z)];
+	}
+
+	// where planeAt() finds the triangle in planes
+	int planeIndex(float x, float z) const
+	{
+		float u = (x + adjFromOrig) / terrainScale;
+		float v = (z + adjFromOrig) / terrainScale;
+		int inX = (int)floor(u);
+		int inZ = (int)floor(v);
+
+		// positions off the terrain use the nearest edge cell
+		if (inX < 0) inX = 0;
+		if (inX > dWidth-1) inX = dWidth-1;
+		if (inZ < 0) inZ = 0;
+		if (inZ > dHeight-1) inZ = dHeight-1;
+
+		int bottom = ((u - inX) + (v - inZ) < 1.0f) ? 0 : 1;
+		return 2 * index(inX, inZ) + bottom;
+	}
+
+	// height of the terrain surface at (x, z), no square root
+	float sampleHeight(float x, float z) const
+	{
+		const TERRAINPLANE &p = planeAt(x, z);
+		return (p.d - p.a * x - p.c * z) / p.b;
+	}
+
+	int getDataWidth() { return dWidth; }		// number of quads along x
+	int getDataHeight() { return dHeight; }	// number of quads along z
+	float getScaleHeight() { return scaleHeight; }
+	float getTerrainScale() { return terrainScale; }
+	void getHeightRange(float &lowest, float &highest);	// of every vertex
+	int getNoOfChunks() { return chunksX * chunksZ; }
+	int getVisibleChunks() { return drawCounts.size(); }		// in the last render(view)
+	CELLINFO getBoundary() { return boundary; }
+	CELLINFO getCellInfo(int x, int z);	// boundary of the quad [x][z]
+
   void printTerrainData();
-	void render();
-	void generateTerrainPoints();
-	void calculateCellBoundary();
-	float getHeight(Vector3f pos);
+	void render(const Frustum *view = NULL);		// NULL draws all of it
+	void setRetainedMesh(bool state);		// true (the default) draws from GPU buffers
+	float getHeight(Vector3f pos) const;
+	// sampleHeight() of n positions at once, out[i] under (x[i], z[i]); on a
+	// big terrain the samples are grouped by tile so that the planes are
+	// read tile after tile instead of all over memory (the samples are
+	// stride floats apart)
+	void sampleHeights(const float *x, const float *z, float *out, int n, int stride = 1) const;
+	// the same for n positions, their y is set
+	void sampleHeights(Vector3f *pos, int n) const { sampleHeights(&pos->x, &pos->z, &pos->y, n, 3); }
 	void posToArrayIndex(Vector3f &pos, int &inX, int &inZ);
-	bool withinBoundary(Vector3f pos, CELLINFO bounds);
-	float distanceToPlane(Vector3f pos);
+	bool withinBoundary(Vector3f pos, CELLINFO bounds) const;
+	float distanceToPlane(Vector3f pos) const;
 	Vector3f calculateFaceNormal(Vector3f p0, Vector3f p1, Vector3f p2);
+	Vector3f cellNormal(int x, int z);
+	Vector3f calculateVertexNormal(int x, int z, int flag);
 	void calculateNormals(int flag);
+	void calculatePlanes();
+
+	// ------------------- editing heights (not while other threads query them)
+	float getVertexHeight(int x, int z) { return heightField[index(x, z)]; }
+	void setHeight(int x, int z, float height);
+	// raise (or lower, amount < 0) the vertices within radius of (x, z),
+	// by amount at the centre down to 0 at the radius
+	void deform(float x, float z, float radius, float amount);
+	// recalculate the normals and planes of edited tiles, before querying them
+	void refresh();
+	bool isDirty() { return !dirtyTiles.empty(); }
 };
 
 #endif
@@ -0,0 +1,69 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ Fixed-Timestep Simulation Clock
+//
+//	See SimulationClock.h for the rationale
+//
+//	##########################################################
+
+#include "SimulationClock.h"
+
+SimulationClock::SimulationClock(double _dt, int _maxSubsteps)
+{
+	dt = _dt;
+	maxSubsteps = (_maxSubsteps < 1) ? 1 : _maxSubsteps;
+	fastForward = 0;
+
+	accumulator = 0.0;
+	lastTime = -1.0;
+	alpha = 1.0f;
+
+	ticks = 0;
+	droppedTicks = 0;
+}
+
+int SimulationClock::advance(double now)
+{
+	// the first frame only starts the clock
+	double elapsed = (lastTime < 0.0) ? 0.0 : now - lastTime;
+	lastTime = now;
+
+	if (fastForward > 0)
+	{
+		// frames no longer follow the wall clock, draw the ticks as they are
+		accumulator = 0.0;
+		alpha = 1.0f;
+		ticks += fastForward;
+		return fastForward;
+	}
+
+	accumulator += elapsed;
+	int substeps = (int)(accumulator / dt);
+
+	// too far behind (a slow machine, a dragged window): run what a frame
+	// may run and let the rest of the time go
+	if (substeps > maxSubsteps)
+	{
+		droppedTicks += substeps - maxSubsteps;
+		accumulator -= dt * (substeps - maxSubsteps);
+		substeps = maxSubsteps;
+	}
+
+	accumulator -= dt * substeps;
+	alpha = (float)(accumulator / dt);
+
+	ticks += substeps;
+	return substeps;
+}
+
+void SimulationClock::setMaxSubsteps(int substeps)
+{
+	maxSubsteps = (substeps < 1) ? 1 : substeps;
+}
+
+void SimulationClock::setFastForward(int ticksPerFrame)
+{
+	fastForward = (ticksPerFrame < 0) ? 0 : ticksPerFrame;
+}
@@ -0,0 +1,68 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ Fixed-Timestep Simulation Clock
+//
+//	An agent moves the same distance every tick, whatever the time
+//	between ticks. When one tick was run per drawn frame, simulated
+//	time ran as fast as the machine could draw: slower under load,
+//	faster on a quick machine.
+//
+//	The clock fixes the length of a tick (dt, 1/60 s by default) and
+//	works out from the wall clock how many ticks a frame must run to
+//	keep simulated time in step with real time:
+//
+//	  real time   - wall-clock time is added to an accumulator and
+//	                whole ticks of dt are taken out of it, 0, 1 or
+//	                more per frame (substeps)
+//	  catch-up    - at most maxSubsteps ticks a frame; if the machine
+//	                falls further behind, the rest is dropped (counted
+//	                in getDroppedTicks()) instead of running ever more
+//	                ticks per frame
+//	  fast-forward - K ticks every frame, as fast as they run,
+//	                whatever the wall clock says
+//
+//	getAlpha() is how far real time is between the last tick and the
+//	next (0 to 1). World::render(alpha) draws agents between where
+//	they were and where they are, so motion looks smooth when frames
+//	and ticks do not line up.
+//
+//	##########################################################
+
+#ifndef SIMULATIONCLOCK_H
+#define SIMULATIONCLOCK_H
+
+/****************************** PROTOTYPES ******************************/
+class SimulationClock
+{
+private:
+	double dt;						// simulated seconds per tick
+	int maxSubsteps;			// most ticks a real-time frame may run
+	int fastForward;			// ticks per frame, 0 runs in real time
+
+	double accumulator;		// real time not yet simulated
+	double lastTime;			// wall clock at the previous frame, < 0 before the first
+	float alpha;
+
+	long ticks;						// ticks handed out so far
+	long droppedTicks;		// ticks given up to catch up
+
+public:
+	SimulationClock(double _dt = 1.0 / 60.0, int _maxSubsteps = 5);
+
+	// called once per frame with the wall clock in seconds,
+	// returns how many ticks to run before drawing the frame
+	int advance(double now);
+
+	float getAlpha() { return alpha; }
+	double getDt() { return dt; }
+	double getSimulatedTime() { return ticks * dt; }
+	long getDroppedTicks() { return droppedTicks; }
+
+	void setMaxSubsteps(int substeps);
+	void setFastForward(int ticksPerFrame);		// 0 returns to real time
+	int getFastForward() { return fastForward; }
+};
+
+#endif
@@ -5,26 +5,27 @@
 //	A C++ Object Oriented Class Integrating OpenGL
 //
 //  Snacks are eaten by Prey
-//	Autonomy is in the auto-spawn in random locations
+//	Eaten snacks die, World grows new ones in random locations
 //
 //	##########################################################
 
 #include "OGLUtil.h"
 #include "Snack.h"
 
-Snack::Snack(int _id, float origX, float origY, float origZ, float speed): Agent(_id, origX, origY, origZ, speed)
+Snack::Snack(int _id, float origX, float origY, float origZ, float speed, Population *population, int slot): Agent(_id, origX, origY, origZ, speed, population, slot)
 {
 
 	fScale = 1.0f;
+	_isEaten = false;
+	_eatenBy = -1;
 
-	vPos.x = origX;
-	vPos.y = origY;
-	vPos.z = origZ;
+	vPos().x = origX;
+	vPos().y = origY;
+	vPos().z = origZ;
 }
 
 Snack::~Snack()
 {
-  cout<<"Snack destroyed!"<<endl;
 }
 
 
@@ -41,9 +42,12 @@ void Snack::render()
 		matPos.identity();
 
 		// set translation and rotation matrix
-		matPos.translate(vPos.x, vPos.y, vPos.z);
-		fCurrAngle += 0.3f;
-		matRot.rotateY(fCurrAngle);
+		Vector3f pos = getRenderPosition();
+		matPos.translate(pos.x, pos.y, pos.z);
+		spin();
+		float c, s;
+		getRenderBasis(c, s);
+		matRot.rotateY(c, s);
 
 		// load position matrix and add rotation
 		//glLoadMatrixf(matPos.matrix);
@@ -53,33 +57,33 @@ void Snack::render()
 	glPopMatrix();
 }
 
+// snacks turn a little every frame they are drawn
+void Snack::spin()
+{
+	fCurrAngle() += 0.3f;
+}
+
 void Snack::update()
 {
 	autonomy();
 }
 
+// an eaten snack stays until the end of the tick, then World replaces
+// it with a new one somewhere else
 void Snack::autonomy()
 {
-	if(_isEaten)
-	{
-		_isEaten = false;
-		int min = _grid->getBottom();
-		int max = _grid->getBottom() + _grid->getBottom();
-
-		int newX = (rand()%max)-min;
-		int newZ = (rand()%max)-min;
-
-		//cout<<"newx,newy"<<newX<<","<<newY<<endl;
-
-		vPos.x = newX;
-		vPos.z = newZ;
-	}
-
 	placeAgentOnTerrain();
 }
-void Snack::isEaten()
+
+void Snack::isEaten(int byId)
 {
 	_isEaten = true;
+	_eatenBy = byId;
+}
+
+bool Snack::wasEaten()
+{
+	return _isEaten;
 }
 
 // void Snack::seek()
@@ -5,7 +5,7 @@
 //	A C++ Object Oriented Class Integrating OpenGL
 //
 //  Snacks are eaten by Prey
-//	Autonomy is in the auto-spawn in random locations
+//	Eaten snacks die, World grows new ones in random locations
 //
 //	##########################################################
 
@@ -17,26 +17,35 @@
 #include "Agent.h"
 
 /****************************** PROTOTYPES ******************************/
-class Snack: public Agent
+// final: nothing derives from it, so calls through a Snack* (and on
+// this inside it) are direct calls the compiler can inline
+class Snack final: public Agent
 {
+  // checkpoints save and restore _isEaten
+  friend class Checkpoint;
+
 protected:
   bool _isEaten;
+  int _eatenBy;     // id of the prey that got it (see ConflictRule)
 
 public:
   // ------------------- constructors destructors
   Snack();
-  Snack(int _id, float origX, float origY, float origZ, float speed);
+  Snack(int _id, float origX, float origY, float origZ, float speed, Population *population = NULL, int slot = 0);
   ~Snack();
 
   // ------------------- update functions
   void render();
   void update();
+  void spin();    // render() does it, and World before drawing all snacks at once
 
   // ------------------- utility functions
   void seek() {}
   void chase() {}
   void autonomy();
-  void isEaten();
+  void isEaten(int byId);
+  bool wasEaten();    // this tick, by getEatenBy()
+  int getEatenBy() { return _eatenBy; }
 
 
   // ------------------- visual representation function
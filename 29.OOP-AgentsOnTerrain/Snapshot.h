@@ -0,0 +1,62 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ World Snapshot (what is drawn, copied out of the agents)
+//
+//	When the simulation and the drawing run on different threads,
+//	the drawing cannot read the agents: they move, are born and die
+//	while it reads them. After a tick World::writeSnapshot() copies
+//	what drawing needs, the position and heading of every agent at
+//	this tick and the last, into a WorldSnapshot. It is handed to
+//	the drawing thread through a TripleBuffer and not written again
+//	until the drawing thread has let go of it.
+//
+//	The states are grouped by SpatialHash cell, and each cell comes
+//	with the box its agents are drawn in, so that the drawing thread
+//	can skip the cells out of sight as World::cullAgents() does.
+//
+//	The vectors keep their capacity from one snapshot to the next, so
+//	writing a snapshot allocates nothing once the population has
+//	stopped growing.
+//
+//	##########################################################
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <vector>
+#include "Category.h"
+#include "Frustum.h"
+
+using namespace std;
+
+// one agent, where it is and where it was a tick before
+struct AGENTSTATE
+{
+	float x, y, z, heading;
+	float prevX, prevY, prevZ, prevHeading;
+};
+
+/****************************** PROTOTYPES ******************************/
+class WorldSnapshot
+{
+public:
+	long tick;							// of the World when it was written
+	double wallTime;				// seconds, when it was published
+	vector<AGENTSTATE> agents[NO_OF_SPECIES];
+
+	// the agents of species s in cell c are
+	// agents[s][cellStart[s][c] .. cellStart[s][c+1]), all of them
+	// inside cells[c]
+	vector<int> cellStart[NO_OF_SPECIES];
+	vector<BOUNDINGBOX> cells;
+
+	WorldSnapshot()
+	{
+		tick = -1;		// nothing written yet
+		wallTime = 0.0;
+	}
+};
+
+#endif
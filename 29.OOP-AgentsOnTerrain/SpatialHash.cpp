@@ -0,0 +1,139 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ Uniform-Grid Spatial Index for Agent Neighbourhoods
+//
+//	See SpatialHash.h for the rationale
+//
+//	##########################################################
+
+#include "SpatialHash.h"
+#include "Grid.h"
+#include "Agent.h"
+
+SpatialHash::SpatialHash(Grid *grid, float cellSize, int capacity)
+{
+	cout<<"---------------------------------->> Creating Spatial Hash"<<endl;
+
+	_left = grid->getLeft();
+	_top = grid->getTop();
+	_cellSize = cellSize;
+	_padding = 1.0f;		// agents move at most fMaxSpeed (0.1) per tick, 1.0 is plenty
+
+	// size the cells from the grid boundary, at least one cell each way
+	_cols = (int)ceil((grid->getRight() - grid->getLeft()) / cellSize);
+	_rows = (int)ceil((grid->getBottom() - grid->getTop()) / cellSize);
+	if (_cols < 1) _cols = 1;
+	if (_rows < 1) _rows = 1;
+	_noOfCells = _cols * _rows;
+
+	_cellStart = new int[NO_OF_SPECIES * _noOfCells + 1];
+	_cellItems = NULL;
+	_agentCell = NULL;
+	_capacity = 0;
+	allocate(capacity);
+
+	cout<<"Cell size: "<<_cellSize<<" Cells: "<<_cols<<" x "<<_rows<<endl;
+}
+
+void SpatialHash::allocate(int capacity)
+{
+	delete[] _cellItems;
+	delete[] _agentCell;
+
+	_capacity = capacity;
+	_cellItems = new int[capacity];
+	_agentCell = new int[capacity];
+}
+
+int SpatialHash::cellX(float x)
+{
+	int cx = (int)floor((x - _left) / _cellSize);
+	if (cx < 0) cx = 0;
+	if (cx >= _cols) cx = _cols - 1;
+	return cx;
+}
+
+int SpatialHash::cellZ(float z)
+{
+	int cz = (int)floor((z - _top) / _cellSize);
+	if (cz < 0) cz = 0;
+	if (cz >= _rows) cz = _rows - 1;
+	return cz;
+}
+
+void SpatialHash::rebuild(Agent **agents, int noOfAgents)
+{
+	PROFILE("spatial hash rebuild");
+
+	if (noOfAgents > _capacity) allocate(noOfAgents);
+
+	int noOfBuckets = NO_OF_SPECIES * _noOfCells;
+	for(int b = 0; b <= noOfBuckets; b++)
+		_cellStart[b] = 0;
+
+	// 1st pass: count agents per bucket
+	for(int i = 0; i < noOfAgents; i++)
+	{
+		Vector3f p = agents[i]->getPosition();
+		int bucket = agents[i]->speciesType * _noOfCells + cellZ(p.z) * _cols + cellX(p.x);
+		_agentCell[i] = bucket;
+		_cellStart[bucket + 1]++;
+	}
+
+	// prefix sum turns counts into offsets
+	for(int b = 0; b < noOfBuckets; b++)
+		_cellStart[b + 1] += _cellStart[b];
+
+	// 2nd pass: scatter in index order, so each bucket stays sorted by index
+	// _cellStart[b] is used as the write cursor and ends up at the next bucket
+	for(int i = 0; i < noOfAgents; i++)
+		_cellItems[_cellStart[_agentCell[i]]++] = i;
+
+	// shift the cursors back so that _cellStart[b] is the start of bucket b
+	for(int b = noOfBuckets; b > 0; b--)
+		_cellStart[b] = _cellStart[b - 1];
+	_cellStart[0] = 0;
+}
+
+void SpatialHash::cellRange(float x, float z, float radius, int &x0, int &z0, int &x1, int &z1)
+{
+	float r = radius + _padding;
+	x0 = cellX(x - r);
+	x1 = cellX(x + r);
+	z0 = cellZ(z - r);
+	z1 = cellZ(z + r);
+}
+
+void SpatialHash::cellBounds(int cx, int cz, float &x0, float &z0, float &x1, float &z1)
+{
+	x0 = _left + cx * _cellSize - _padding;
+	x1 = x0 + _cellSize + 2 * _padding;
+	z0 = _top + cz * _cellSize - _padding;
+	z1 = z0 + _cellSize + 2 * _padding;
+
+	// a cell further for the strays
+	if (cx == 0) x0 -= _cellSize;
+	if (cx == _cols - 1) x1 += _cellSize;
+	if (cz == 0) z0 -= _cellSize;
+	if (cz == _rows - 1) z1 += _cellSize;
+}
+
+int SpatialHash::cellBegin(SpeciesType species, int cx, int cz)
+{
+	return _cellStart[species * _noOfCells + cz * _cols + cx];
+}
+
+int SpatialHash::cellEnd(SpeciesType species, int cx, int cz)
+{
+	return _cellStart[species * _noOfCells + cz * _cols + cx + 1];
+}
+
+SpatialHash::~SpatialHash()
+{
+	delete[] _cellStart;
+	delete[] _cellItems;
+	delete[] _agentCell;
+	cout<<"Spatial Hash destroyed"<<endl;
+}
@@ -0,0 +1,74 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ Uniform-Grid Spatial Index for Agent Neighbourhoods
+//
+//	Seeking by looping over every agent costs N*N distance tests
+//	per tick. The spatial hash buckets agents into square cells on
+//	the x/z plane (one table per SpeciesType), so an agent only
+//	tests the agents in the cells overlapping its seek radius.
+//
+//	The table is rebuilt once per tick with a counting sort, which
+//	keeps every cell's agents in ascending index order. seek() can
+//	therefore return exactly the same target as the brute-force loop
+//	(the lowest index that passes the tests).
+//
+//	##########################################################
+
+#ifndef SPATIALHASH_H
+#define SPATIALHASH_H
+
+#include "OGLUtil.h"
+#include "Category.h"
+
+class Grid;
+class Agent;
+
+/****************************** PROTOTYPES ******************************/
+class SpatialHash
+{
+private:
+	float _left, _top;		// world-space origin of cell (0, 0)
+	float _cellSize;			// width of a square cell
+	float _padding;				// extra search distance for agents moving within a tick
+	int _cols, _rows;			// number of cells along x and z
+	int _noOfCells;
+
+	int _capacity;				// number of agents the arrays are sized for
+	int *_cellStart;			// [species][cell] offsets into _cellItems (+1 sentinel)
+	int *_cellItems;			// agent indices sorted by species then cell
+	int *_agentCell;			// scratch: bucket of each agent during rebuild
+
+	void allocate(int capacity);
+
+public:
+	SpatialHash(Grid *grid, float cellSize, int capacity);
+	~SpatialHash();
+
+	// rebuild all buckets from the current agent positions
+	void rebuild(Agent **agents, int noOfAgents);
+
+	// clamp a world position into a cell column/row
+	int cellX(float x);
+	int cellZ(float z);
+
+	// cell rectangle covering a circle of radius around (x, z)
+	void cellRange(float x, float z, float radius, int &x0, int &z0, int &x1, int &z1);
+
+	// the agents of a species in one cell are _cellItems[begin..end)
+	int cellBegin(SpeciesType species, int cx, int cz);
+	int cellEnd(SpeciesType species, int cx, int cz);
+	int item(int k) { return _cellItems[k]; }
+
+	float getCellSize() { return _cellSize; }
+	int getCols() { return _cols; }
+	int getRows() { return _rows; }
+
+	// the area the agents in a cell can be in, a tick after the rebuild
+	// (cells on the edge also hold agents that strayed off the grid)
+	void cellBounds(int cx, int cz, float &x0, float &z0, float &x1, float &z1);
+	void setPadding(float padding) { _padding = padding; }
+};
+
+#endif
@@ -0,0 +1,77 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ Single-Producer Single-Consumer Ring Buffer
+//
+//	A fixed size queue between exactly two threads, one pushing and
+//	one popping, with no locks. Each side only ever writes its own
+//	counter (tail for the producer, head for the consumer) and reads
+//	the other's, so neither can be held up by the other being
+//	descheduled while holding a mutex.
+//
+//	push() and pop() return false instead of waiting when the ring
+//	is full or empty, the caller decides whether to wait or not.
+//
+//	##########################################################
+
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <atomic>
+using namespace std;
+
+/****************************** PROTOTYPES ******************************/
+template <class T>
+class SpscRing
+{
+private:
+	T *slots;
+	unsigned int mask;						// capacity - 1, capacity is a power of 2
+
+	// each counter on its own cache line, so the two threads do not
+	// invalidate each other's line on every push and pop
+	alignas(64) atomic<unsigned int> head;		// next slot to pop (consumer)
+	alignas(64) atomic<unsigned int> tail;		// next slot to push (producer)
+
+public:
+	SpscRing(unsigned int capacity)
+	{
+		unsigned int size = 1;
+		while (size < capacity) size <<= 1;
+
+		slots = new T[size];
+		mask = size - 1;
+		head.store(0);
+		tail.store(0);
+	}
+
+	~SpscRing()
+	{
+		delete[] slots;
+	}
+
+	// producer thread only
+	bool push(const T &item)
+	{
+		unsigned int t = tail.load(memory_order_relaxed);
+		if (t - head.load(memory_order_acquire) > mask) return false;	// full
+
+		slots[t & mask] = item;
+		tail.store(t + 1, memory_order_release);
+		return true;
+	}
+
+	// consumer thread only
+	bool pop(T &item)
+	{
+		unsigned int h = head.load(memory_order_relaxed);
+		if (h == tail.load(memory_order_acquire)) return false;	// empty
+
+		item = slots[h & mask];
+		head.store(h + 1, memory_order_release);
+		return true;
+	}
+};
+
+#endif
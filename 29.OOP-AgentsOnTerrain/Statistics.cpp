@@ -0,0 +1,236 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ In-Simulation Statistics Aggregator
+//
+//	See Statistics.h for the rationale and the file layout
+//
+//	##########################################################
+
+#include <iostream>
+#include <string.h>
+#include "Statistics.h"
+#include "Timing.h"
+
+using namespace std;
+
+// where value falls in count bins over [low, high), the edges take the rest
+static int bin(float value, float low, float high, int count)
+{
+	if (high <= low) return 0;
+	int b = (int)((value - low) / (high - low) * count);
+	if (b < 0) return 0;
+	return (b >= count) ? count - 1 : b;
+}
+
+Statistics::Statistics(const char *filename, World *world, int _every)
+{
+	every = (_every < 1) ? 1 : _every;
+
+	Grid *grid = world->grid;
+	cols = rows = (int)grid->getSegments();
+	if (cols < 1) cols = rows = 1;
+	left = grid->getLeft();
+	top = grid->getTop();
+	right = grid->getRight();
+	bottom = grid->getBottom();
+	world->terrain->getHeightRange(lowest, highest);
+
+	noOfPartials = 0;
+	partials = NULL;
+	total.density.resize(NO_OF_SPECIES * rows * cols);
+	clear(total);
+
+	lastMeals = world->noOfMeals;
+	lastBirths = world->noOfBirths;
+	lastDeaths = world->noOfDeaths;
+	lastConflicts = world->noOfConflicts;
+
+	recordsWritten = 0;
+	bytesWritten = 0;
+	captureSeconds = 0.0;
+
+	file = fopen(filename, "wb");
+	if (file == NULL)
+	{
+		cout<<">> Statistics file could not be opened: "<<filename<<endl;
+		return;
+	}
+
+	// a record is small, they go to the disk 64KB at a time
+	setvbuf(file, NULL, _IOFBF, 1 << 16);
+
+	char magic[8] = "ABMSTAT";
+	uint32_t info[6] = { STATISTICS_VERSION, (uint32_t)NO_OF_SPECIES, (uint32_t)cols, (uint32_t)rows,
+		(uint32_t)STATISTICS_HEIGHT_BINS, (uint32_t)every };
+	float bounds[6] = { left, top, right, bottom, lowest, highest };
+	fwrite(magic, 1, sizeof(magic), file);
+	fwrite(info, sizeof(uint32_t), 6, file);
+	fwrite(bounds, sizeof(float), 6, file);
+	bytesWritten = sizeof(magic) + sizeof(info) + sizeof(bounds);
+
+	cout<<"---------------------------------->> Recording statistics to "<<filename<<" every "<<every<<" ticks"<<endl;
+}
+
+void Statistics::clear(STATISTICSPARTIAL &partial)
+{
+	memset(partial.population, 0, sizeof(partial.population));
+	memset(partial.targeting, 0, sizeof(partial.targeting));
+	memset(partial.heights, 0, sizeof(partial.heights));
+	for(int s = 0; s < NO_OF_SPECIES; s++)
+	{
+		partial.speed[s] = 0.0;
+		partial.distance[s] = 0.0;
+	}
+	fill(partial.density.begin(), partial.density.end(), 0);
+}
+
+// agents[begin, end) into one thread's partial, read only
+void Statistics::accumulate(World *world, STATISTICSPARTIAL &partial, int begin, int end)
+{
+	for(int i = begin; i < end; i++)
+	{
+		Agent *agent = world->agents[i];
+		int s = agent->speciesType;
+		Vector3f p = agent->getPosition();
+
+		partial.population[s]++;
+		partial.speed[s] += agent->getSpeed();
+
+		float distance = -1.0f;
+		if (s == PREDATOR) distance = ((Predator*)agent)->distanceToTarget();
+		else if (s == PREY) distance = ((Prey*)agent)->distanceToTarget();
+		if (distance >= 0.0f)
+		{
+			partial.targeting[s]++;
+			partial.distance[s] += distance;
+		}
+
+		int cx = bin(p.x, left, right, cols);
+		int cz = bin(p.z, top, bottom, rows);
+		partial.density[(s * rows + cz) * cols + cx]++;
+		partial.heights[s][bin(p.y, lowest, highest, STATISTICS_HEIGHT_BINS)]++;
+	}
+}
+
+// the partials of all threads into total
+void Statistics::merge()
+{
+	total = partials[0];
+	for(int t = 1; t < noOfPartials; t++)
+	{
+		const STATISTICSPARTIAL &partial = partials[t];
+		for(int s = 0; s < NO_OF_SPECIES; s++)
+		{
+			total.population[s] += partial.population[s];
+			total.speed[s] += partial.speed[s];
+			total.targeting[s] += partial.targeting[s];
+			total.distance[s] += partial.distance[s];
+			for(int b = 0; b < STATISTICS_HEIGHT_BINS; b++)
+				total.heights[s][b] += partial.heights[s][b];
+		}
+		for(size_t c = 0; c < total.density.size(); c++)
+			total.density[c] += partial.density[c];
+	}
+}
+
+void Statistics::capture(World *world)
+{
+	if (file == NULL || world->tick % every != 0) return;
+
+	PROFILE("statistics");
+	double t0 = secondsNow();
+
+	// a partial per thread, the world may have changed its threads since
+	int threads = (world->threadPool != NULL) ? world->threadPool->size() : 1;
+	if (threads != noOfPartials)
+	{
+		delete[] partials;
+		partials = new STATISTICSPARTIAL[threads];
+		noOfPartials = threads;
+		for(int t = 0; t < noOfPartials; t++)
+			partials[t].density.resize(NO_OF_SPECIES * rows * cols);
+	}
+	for(int t = 0; t < noOfPartials; t++)
+		clear(partials[t]);
+
+	if (world->threadPool != NULL)
+		world->threadPool->parallelFor(world->agentNo, [this, world](int thread, int begin, int end) {
+			accumulate(world, partials[thread], begin, end);
+		});
+	else
+		accumulate(world, partials[0], 0, world->agentNo);
+
+	merge();
+	writeRecord(world);
+
+	captureSeconds += secondsNow() - t0;
+}
+
+float Statistics::getMeanSpeed(SpeciesType species)
+{
+	if (total.population[species] == 0) return 0.0f;
+	return total.speed[species] / total.population[species];
+}
+
+float Statistics::getMeanDistance(SpeciesType species)
+{
+	if (total.targeting[species] == 0) return -1.0f;
+	return total.distance[species] / total.targeting[species];
+}
+
+void Statistics::writeRecord(World *world)
+{
+	uint64_t tick = world->tick;
+	uint32_t events[4] = {
+		(uint32_t)(world->noOfMeals - lastMeals), (uint32_t)(world->noOfBirths - lastBirths),
+		(uint32_t)(world->noOfDeaths - lastDeaths), (uint32_t)(world->noOfConflicts - lastConflicts) };
+	lastMeals = world->noOfMeals;
+	lastBirths = world->noOfBirths;
+	lastDeaths = world->noOfDeaths;
+	lastConflicts = world->noOfConflicts;
+
+	float speed[NO_OF_SPECIES], distance[NO_OF_SPECIES];
+	for(int s = 0; s < NO_OF_SPECIES; s++)
+	{
+		speed[s] = getMeanSpeed((SpeciesType)s);
+		distance[s] = getMeanDistance((SpeciesType)s);
+	}
+
+	fwrite(&tick, sizeof(uint64_t), 1, file);
+	fwrite(total.population, sizeof(uint32_t), NO_OF_SPECIES, file);
+	fwrite(events, sizeof(uint32_t), 4, file);
+	fwrite(speed, sizeof(float), NO_OF_SPECIES, file);
+	fwrite(total.targeting, sizeof(uint32_t), NO_OF_SPECIES, file);
+	fwrite(distance, sizeof(float), NO_OF_SPECIES, file);
+	fwrite(&total.density[0], sizeof(uint32_t), total.density.size(), file);
+	fwrite(total.heights, sizeof(uint32_t), NO_OF_SPECIES * STATISTICS_HEIGHT_BINS, file);
+
+	recordsWritten++;
+	bytesWritten += sizeof(uint64_t) + sizeof(events) + NO_OF_SPECIES * (2 * sizeof(uint32_t) + 2 * sizeof(float))
+		+ total.density.size() * sizeof(uint32_t) + sizeof(total.heights);
+}
+
+void Statistics::close()
+{
+	if (file == NULL) return;
+
+	fclose(file);
+	file = NULL;
+}
+
+void Statistics::printStats()
+{
+	cout<<"statistics: "<<recordsWritten<<" records, "<<bytesWritten / 1024.0<<" KB, "
+		<<captureSeconds<<" s capturing"<<endl;
+	cout<<"last record: population "<<total.population[PREDATOR]<<"/"<<total.population[PREY]<<"/"<<total.population[SNACK]
+		<<" | mean speed "<<getMeanSpeed(PREDATOR)<<"/"<<getMeanSpeed(PREY)
+		<<" | mean distance to target "<<getMeanDistance(PREDATOR)<<"/"<<getMeanDistance(PREY)<<endl;
+}
+
+Statistics::~Statistics()
+{
+	close();
+	delete[] partials;
+}
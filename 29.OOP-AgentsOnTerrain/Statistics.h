@@ -0,0 +1,117 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ In-Simulation Statistics Aggregator
+//
+//	How many snacks were eaten used to be counted from the "eaten
+//	by" lines on cout, anything more (where the agents gather, how
+//	fast they go) needed a trajectory file of every agent every few
+//	ticks, gigabytes for a long run, and a program to add it all up.
+//
+//	Statistics adds it up while the simulation runs. After a tick
+//	capture() reads the agents where they are (nothing is copied)
+//	and works out per species:
+//	  the population, the mean speed, the mean distance to the
+//	  target of those that have one, how many agents stand in each
+//	  cell of the Grid (its segments) and how many at each height of
+//	  the terrain (STATISTICS_HEIGHT_BINS bins between the lowest and
+//	  highest point of the terrain when the file was opened)
+//	and of the world: meals, births, deaths and conflicts
+//	since the previous record.
+//
+//	With a ThreadPool (World::setThreads) each thread adds up its
+//	share of the agents in a STATISTICSPARTIAL of its own, no locks and
+//	no atomics, and the partials are merged when the loop is over.
+//
+//	File layout (byte order of the machine):
+//	  header: "ABMSTAT\0", uint32 version, uint32 species, uint32 cols,
+//	          uint32 rows, uint32 heightBins, uint32 every,
+//	          float left, top, right, bottom, lowest, highest
+//	  then one record per recorded tick, a column per measure:
+//	    uint64 tick,
+//	    species x uint32 population,
+//	    uint32 meals, births, deaths, conflicts,
+//	    species x float meanSpeed,
+//	    species x uint32 targeting, species x float meanDistance,
+//	    species x rows x cols x uint32 density (row by row, z then x),
+//	    species x heightBins x uint32 heights
+//	A record of the default world is 1.4KB, whatever the number of
+//	agents.
+//
+//	##########################################################
+
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+#include "World.h"
+
+using namespace std;
+
+#define STATISTICS_VERSION 2
+#define STATISTICS_HEIGHT_BINS 16
+
+// what one thread adds up over its share of the agents, a cache line
+// of its own so that threads do not write each other's lines
+struct alignas(64) STATISTICSPARTIAL
+{
+	uint32_t population[NO_OF_SPECIES];
+	double speed[NO_OF_SPECIES];				// sums, divided when written
+	uint32_t targeting[NO_OF_SPECIES];	// how many have a target
+	double distance[NO_OF_SPECIES];			// to the target, of those that have one
+	vector<uint32_t> density;						// species x rows x cols
+	uint32_t heights[NO_OF_SPECIES][STATISTICS_HEIGHT_BINS];
+};
+
+/****************************** PROTOTYPES ******************************/
+class Statistics
+{
+private:
+	FILE *file;
+	int every;											// record every so many ticks
+
+	// the density cells and height bins
+	int cols, rows;
+	float left, top, right, bottom;
+	float lowest, highest;
+
+	STATISTICSPARTIAL *partials;				// one per thread of the world
+	int noOfPartials;
+	STATISTICSPARTIAL total;
+
+	// the world's counters at the previous record
+	long lastMeals, lastBirths, lastDeaths, lastConflicts;
+
+	// statistics of the statistics
+	long recordsWritten;
+	uint64_t bytesWritten;
+	double captureSeconds;				// time spent in capture() on the simulation thread
+
+	void clear(STATISTICSPARTIAL &partial);
+	void accumulate(World *world, STATISTICSPARTIAL &partial, int begin, int end);
+	void merge();
+	void writeRecord(World *world);
+
+public:
+	Statistics(const char *filename, World *world, int _every);
+	~Statistics();
+
+	bool isOpen() { return file != NULL; }
+
+	// called after every tick, records when tick is a multiple of every
+	void capture(World *world);
+
+	// the last record, species by species
+	int getPopulation(SpeciesType species) { return total.population[species]; }
+	float getMeanSpeed(SpeciesType species);
+	float getMeanDistance(SpeciesType species);		// -1 if none has a target
+
+	void close();
+	double getCaptureSeconds() { return captureSeconds; }
+	void printStats();
+};
+
+#endif
@@ -0,0 +1,104 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ Thread Pool
+//
+//	See ThreadPool.h for the rationale
+//
+//	##########################################################
+
+#include <iostream>
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(int threads)
+{
+	if (threads < 1) threads = 1;
+	noOfThreads = threads;
+
+	jobSize = 0;
+	generation = 0;
+	pending = 0;
+	stopping = false;
+
+	// the calling thread is thread 0, only the others are spawned
+	for(int i = 1; i < noOfThreads; i++)
+		workers.push_back(thread(&ThreadPool::workerLoop, this, i));
+
+	cout<<"---------------------------------->> Thread Pool: "<<noOfThreads<<" threads"<<endl;
+}
+
+void ThreadPool::runRange(int index)
+{
+	// the same split for the same loop size and thread count, every time
+	int begin = (int)((long)jobSize * index / noOfThreads);
+	int end = (int)((long)jobSize * (index + 1) / noOfThreads);
+
+	if (begin < end) job(index, begin, end);
+}
+
+void ThreadPool::workerLoop(int index)
+{
+	int seen = 0;
+
+	while (true)
+	{
+		{
+			unique_lock<mutex> guard(lock);
+			workReady.wait(guard, [&]{ return stopping || generation != seen; });
+			if (stopping) return;
+			seen = generation;
+		}
+
+		runRange(index);
+
+		{
+			unique_lock<mutex> guard(lock);
+			if (--pending == 0) workDone.notify_one();
+		}
+	}
+}
+
+void ThreadPool::parallelFor(int count, function<void(int, int)> body)
+{
+	parallelFor(count, [&body](int /*thread*/, int begin, int end) { body(begin, end); });
+}
+
+void ThreadPool::parallelFor(int count, function<void(int, int, int)> body)
+{
+	if (noOfThreads == 1 || count < noOfThreads)
+	{
+		// not worth waking anybody up
+		body(0, 0, count);
+		return;
+	}
+
+	{
+		unique_lock<mutex> guard(lock);
+		job = body;
+		jobSize = count;
+		pending = noOfThreads - 1;
+		generation++;
+	}
+	workReady.notify_all();
+
+	// the calling thread takes the first range
+	runRange(0);
+
+	unique_lock<mutex> guard(lock);
+	workDone.wait(guard, [&]{ return pending == 0; });
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		unique_lock<mutex> guard(lock);
+		stopping = true;
+	}
+	workReady.notify_all();
+
+	for(size_t i = 0; i < workers.size(); i++)
+		workers[i].join();
+
+	cout<<"Thread Pool destroyed"<<endl;
+}
@@ -0,0 +1,61 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ Thread Pool
+//
+//	A fixed set of worker threads that split a loop over agents
+//	between them. parallelFor() hands every thread one contiguous
+//	range of the loop and returns when all ranges are done, so the
+//	calling thread can treat it like an ordinary for loop.
+//
+//	The split depends only on the loop size and the number of
+//	threads, and the calling thread does the first range itself.
+//	Range k is always run by thread k (the caller is thread 0), and
+//	the body can be told k to keep per-thread data of its own.
+//
+//	##########################################################
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <vector>
+using namespace std;
+
+/****************************** PROTOTYPES ******************************/
+class ThreadPool
+{
+private:
+	vector<thread> workers;
+	mutex lock;
+	condition_variable workReady;		// signalled when a new loop is posted
+	condition_variable workDone;		// signalled when a worker finishes its range
+
+	function<void(int, int, int)> job;	// loop body for thread, range [begin, end)
+	int jobSize;										// number of iterations in the loop
+	int generation;									// increments with every posted loop
+	int pending;										// workers still running the loop
+	bool stopping;
+
+	int noOfThreads;								// workers + the calling thread
+
+	void workerLoop(int index);
+	void runRange(int index);
+
+public:
+	ThreadPool(int threads);
+	~ThreadPool();
+
+	int size() { return noOfThreads; }
+
+	// run body(begin, end) over [0, count) split across all threads
+	void parallelFor(int count, function<void(int, int)> body);
+	// the same, body(thread, begin, end) with thread in [0, size())
+	void parallelFor(int count, function<void(int, int, int)> body);
+};
+
+#endif
@@ -0,0 +1,38 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ Timing Helper
+//
+//	The programs (Headless, Ensemble, Benchmark, RenderBenchmark)
+//	and the recorders time runs and phases in seconds of a steady
+//	clock, which does not jump when the system time is set.
+//
+//	Constructors and destructors print, which swamps the timings of
+//	phases that make and delete many objects; silence() mutes cout
+//	around them.
+//
+//	##########################################################
+
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <iostream>
+#include <chrono>
+
+using namespace std;
+
+// seconds since an arbitrary epoch
+inline double secondsNow()
+{
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// true mutes cout, false lets it through again
+inline void silence(bool state)
+{
+	static streambuf *original = cout.rdbuf();
+	cout.rdbuf(state ? NULL : original);
+}
+
+#endif
@@ -0,0 +1,152 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ Trajectory Recorder
+//
+//	See TrajectoryWriter.h for the rationale and the file layout
+//
+//	##########################################################
+
+#include <iostream>
+#include "TrajectoryWriter.h"
+#include "Timing.h"
+
+using namespace std;
+
+TrajectoryWriter::TrajectoryWriter(const char *filename, int agentNo, int _every, int _noOfFrames)
+{
+	every = (_every < 1) ? 1 : _every;
+	capacity = agentNo;
+	noOfFrames = _noOfFrames;
+
+	// by default as many frames as fit in 64MB (4 to 1024), small worlds
+	// record far faster than the writer thread wakes up to write them
+	if (noOfFrames < 1)
+	{
+		long frameBytes = (long)capacity * (sizeof(uint32_t) + sizeof(uint8_t) + 4 * sizeof(float)) + 1;
+		noOfFrames = (64L << 20) / frameBytes;
+		if (noOfFrames < 4) noOfFrames = 4;
+		if (noOfFrames > 1024) noOfFrames = 1024;
+	}
+
+	framesWritten = 0;
+	bytesWritten = 0;
+	captureSeconds = 0.0;
+
+	frames = new TRAJECTORYFRAME[noOfFrames];
+	for(int f = 0; f < noOfFrames; f++)
+	{
+		frames[f].tick = 0;
+		frames[f].count = 0;
+		frames[f].id = new uint32_t[capacity];
+		frames[f].species = new uint8_t[capacity];
+		frames[f].x = new float[capacity];
+		frames[f].y = new float[capacity];
+		frames[f].z = new float[capacity];
+		frames[f].heading = new float[capacity];
+	}
+	writer = new BackgroundWriter<TRAJECTORYFRAME>(frames, noOfFrames);
+
+	file = fopen(filename, "wb");
+	if (file == NULL)
+	{
+		cout<<">> Trajectory file could not be opened: "<<filename<<endl;
+		return;
+	}
+
+	// big writes, the writer thread is the only one touching the file
+	setvbuf(file, NULL, _IOFBF, 1 << 20);
+
+	char magic[8] = "ABMTRAJ";
+	uint32_t info[3] = { TRAJECTORY_VERSION, (uint32_t)agentNo, (uint32_t)every };
+	fwrite(magic, 1, sizeof(magic), file);
+	fwrite(info, sizeof(uint32_t), 3, file);
+	bytesWritten = sizeof(magic) + sizeof(info);
+
+	writer->start([this](TRAJECTORYFRAME *frame) { writeFrame(frame); });
+
+	cout<<"---------------------------------->> Recording trajectories to "<<filename<<" every "<<every<<" ticks"<<endl;
+}
+
+void TrajectoryWriter::capture(World *world)
+{
+	if (file == NULL || world->tick % every != 0) return;
+
+	double t0 = secondsNow();
+
+	// waits for the writer to give a frame back if it has fallen behind
+	TRAJECTORYFRAME *frame = writer->acquire();
+
+	int n = world->agentNo < capacity ? world->agentNo : capacity;
+	frame->tick = world->tick;
+	frame->count = n;
+
+	for(int i = 0; i < n; i++)
+	{
+		Agent *agent = world->agents[i];
+		Vector3f p = agent->getPosition();
+
+		frame->id[i] = agent->getID();
+		frame->species[i] = (uint8_t)agent->speciesType;
+		frame->x[i] = p.x;
+		frame->y[i] = p.y;
+		frame->z[i] = p.z;
+		frame->heading[i] = agent->getHeading();
+	}
+
+	writer->submit(frame);
+
+	captureSeconds += secondsNow() - t0;
+}
+
+void TrajectoryWriter::writeFrame(TRAJECTORYFRAME *frame)
+{
+	uint32_t n = frame->count;
+
+	fwrite(&frame->tick, sizeof(uint64_t), 1, file);
+	fwrite(&frame->count, sizeof(uint32_t), 1, file);
+	fwrite(frame->id, sizeof(uint32_t), n, file);
+	fwrite(frame->species, sizeof(uint8_t), n, file);
+	fwrite(frame->x, sizeof(float), n, file);
+	fwrite(frame->y, sizeof(float), n, file);
+	fwrite(frame->z, sizeof(float), n, file);
+	fwrite(frame->heading, sizeof(float), n, file);
+
+	framesWritten++;
+	bytesWritten += sizeof(uint64_t) + sizeof(uint32_t) + (uint64_t)n * (sizeof(uint32_t) + sizeof(uint8_t) + 4 * sizeof(float));
+}
+
+void TrajectoryWriter::close()
+{
+	if (file == NULL) return;
+
+	writer->stop();
+
+	fflush(file);
+	fclose(file);
+	file = NULL;
+}
+
+void TrajectoryWriter::printStats()
+{
+	cout<<"trajectory: "<<framesWritten<<" frames, "<<bytesWritten / (1024.0 * 1024.0)<<" MB, "
+		<<captureSeconds<<" s capturing, "<<writer->getStalls()<<" waits for the writer"<<endl;
+}
+
+TrajectoryWriter::~TrajectoryWriter()
+{
+	close();
+
+	for(int f = 0; f < noOfFrames; f++)
+	{
+		delete[] frames[f].id;
+		delete[] frames[f].species;
+		delete[] frames[f].x;
+		delete[] frames[f].y;
+		delete[] frames[f].z;
+		delete[] frames[f].heading;
+	}
+	delete writer;
+	delete[] frames;
+}
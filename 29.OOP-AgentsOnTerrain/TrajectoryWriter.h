@@ -0,0 +1,83 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ Trajectory Recorder
+//
+//	Records where every agent is every N ticks for analysis after
+//	the run. The simulation thread only copies each agent's id,
+//	species, position and heading into a preallocated frame and
+//	hands the frame to a BackgroundWriter, whose thread writes the
+//	file. Nothing is allocated and nothing waits on the disk during
+//	a run (unless the disk is slower than the frames coming in, then
+//	capture() waits for a free frame).
+//
+//	File layout (byte order of the machine):
+//	  header: "ABMTRAJ\0", uint32 version, uint32 agentNo, uint32 every
+//	  then one chunk per recorded tick:
+//	    uint64 tick, uint32 count,
+//	    count x uint32 id, count x uint8 species,
+//	    count x float x, count x float y, count x float z,
+//	    count x float heading
+//	Each column is contiguous, so a reader can load only the ones it
+//	needs (e.g. x and z for a density map) and skip the rest.
+//
+//	##########################################################
+
+#ifndef TRAJECTORYWRITER_H
+#define TRAJECTORYWRITER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "BackgroundWriter.h"
+#include "World.h"
+
+#define TRAJECTORY_VERSION 1
+
+// one recorded tick, the columns of a chunk
+struct TRAJECTORYFRAME
+{
+	uint64_t tick;
+	uint32_t count;
+	uint32_t *id;
+	uint8_t *species;
+	float *x, *y, *z, *heading;
+};
+
+/****************************** PROTOTYPES ******************************/
+class TrajectoryWriter
+{
+private:
+	FILE *file;
+	int every;										// record every so many ticks
+	int capacity;									// agents per frame
+
+	TRAJECTORYFRAME *frames;
+	int noOfFrames;
+	BackgroundWriter<TRAJECTORYFRAME> *writer;
+
+	// statistics
+	long framesWritten;
+	uint64_t bytesWritten;
+	double captureSeconds;				// time spent in capture() on the simulation thread
+
+	void writeFrame(TRAJECTORYFRAME *frame);		// on the writer's thread
+
+public:
+	// _noOfFrames frames can be queued for writing, 0 sizes the queue to 64MB
+	TrajectoryWriter(const char *filename, int agentNo, int _every, int _noOfFrames = 0);
+	~TrajectoryWriter();
+
+	bool isOpen() { return file != NULL; }
+
+	// called after every tick, records the agents when tick is a multiple of every
+	void capture(World *world);
+
+	// write what is still queued and close the file (also done by the destructor)
+	void close();
+
+	double getCaptureSeconds() { return captureSeconds; }
+	void printStats();
+};
+
+#endif
@@ -0,0 +1,77 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ Lock-Free Triple Buffer
+//
+//	Hands the latest of something (a snapshot of the world) from one
+//	thread that writes it to one thread that reads it, each at its own
+//	rate. Of the three slots the producer owns one (back), the
+//	consumer owns one (front) and the third (middle) holds the latest
+//	complete one. publish() swaps back and middle, update() swaps
+//	middle and front if there is something new in it. The swaps are
+//	one atomic exchange each, so neither thread ever waits for the
+//	other: the producer never overwrites what the consumer is reading,
+//	and the consumer always gets the newest complete slot, skipping
+//	any it was too slow to see.
+//
+//	##########################################################
+
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+using namespace std;
+
+#define TRIPLEBUFFER_FRESH 4		// set in middle when the consumer has not taken it
+
+/****************************** PROTOTYPES ******************************/
+template <class T>
+class TripleBuffer
+{
+private:
+	T slots[3];
+	int back;							// producer thread only
+	int front;						// consumer thread only
+
+	// the only index both threads touch, on a cache line of its own
+	alignas(64) atomic<int> middle;
+
+public:
+	TripleBuffer()
+	{
+		back = 0;
+		middle.store(1);
+		front = 2;
+	}
+
+	// producer thread only: the slot to write the next one into
+	T &getBack()
+	{
+		return slots[back];
+	}
+
+	// producer thread only: the back slot is complete, hand it over
+	void publish()
+	{
+		back = middle.exchange(back | TRIPLEBUFFER_FRESH, memory_order_acq_rel) & ~TRIPLEBUFFER_FRESH;
+	}
+
+	// consumer thread only: take the latest complete slot, false if
+	// nothing was published since the last update()
+	bool update()
+	{
+		if ((middle.load(memory_order_relaxed) & TRIPLEBUFFER_FRESH) == 0) return false;
+
+		front = middle.exchange(front, memory_order_acq_rel) & ~TRIPLEBUFFER_FRESH;
+		return true;
+	}
+
+	// consumer thread only: stays the same until the next update()
+	const T &getFront()
+	{
+		return slots[front];
+	}
+};
+
+#endif
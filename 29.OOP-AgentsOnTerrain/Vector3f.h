@@ -4,6 +4,10 @@
 //	----------------------------------------------------------
 //	A C++ OpenGL Object Orientation Application
 //	An OpenGL Vector3f Class
+//
+//	A plain value: three floats, no virtual functions and nothing
+//	on the heap. Arguments are passed by const reference and the
+//	constructors are constexpr, so constant vectors cost nothing.
 //	##########################################################
 
 
@@ -26,29 +30,19 @@ public:
 	float z;
 
 	/******************* constructors *******************/
-	Vector3f()
-	{
-		x = 0.0f;
-		y = 0.0f;
-		z = 0.0f;
-	}
+	constexpr Vector3f(): x(0.0f), y(0.0f), z(0.0f) {}
 
-	Vector3f(float vx, float vy, float vz)
-	{
-		x = vx;
-		y = vy;
-		z = vz;
-	}
+	constexpr Vector3f(float vx, float vy, float vz): x(vx), y(vy), z(vz) {}
 
 	/******************* functions *******************/
-	float dotProduct(Vector3f v2)
+	float dotProduct(const Vector3f &v2) const
 	{
 		float dotProd = x*v2.x + y*v2.y + z*v2.z;
 
 		return dotProd;
 	}
 
-	float angleDotProd(Vector3f v2)
+	float angleDotProd(const Vector3f &v2) const
 	{
 		Vector3f v1(x, y, z);	// this vector
 		float angle = acos(v1.dotProduct(v2)/(v1.magnitude() * v2.magnitude()));
@@ -56,14 +50,14 @@ public:
 		return angle * (180/PI);
 	}
 
-	float magnitude()
+	float magnitude() const
 	{
 		float mag = sqrt((x*x) + (y*y) + (z*z));
 
 		return mag;
 	}
 
-	static float distance(Vector3f v1, Vector3f v2)
+	static float distance(const Vector3f &v1, const Vector3f &v2)
 	{
 		float dx = v1.x - v2.x;
 		float dy = v1.y - v2.y;
@@ -86,7 +80,7 @@ public:
 		z = v.z / vMag;
 	}
 
-	Vector3f crossProduct(Vector3f v2)
+	Vector3f crossProduct(const Vector3f &v2) const
 	{
 		Vector3f vC(0, 0, 0);
 
@@ -97,12 +91,12 @@ public:
 		return vC;
 	}
 
-	void print()
+	void print() const
 	{
 		cout<<x<<" "<<y<<" "<<z<<endl;
 	}
 
-	static Vector3f vRotate2D(float angle, Vector3f target, Vector3f pos)
+	static Vector3f vRotate2D(float angle, const Vector3f &target, const Vector3f &pos)
 	{
 		// Calculate component distance
 		float distX = target.x - pos.x;
@@ -142,7 +136,7 @@ public:
 	// test if a point is above or below a line
 	// used for calculating agents on the surfaces (plane) of terrain
 	// each plane is made up of two triangles (p0, p1, p2) (p2, p1, p3)
-	static bool isAboveLine(Vector3f v1, Vector3f v2, Vector3f point)
+	static bool isAboveLine(const Vector3f &v1, const Vector3f &v2, const Vector3f &point)
 	{
 		bool _isAboveLine = false;
 
@@ -159,7 +153,7 @@ public:
 
 /******************* operator overloading *******************/
 	// vector summation
-	Vector3f operator+(Vector3f v) const
+	Vector3f operator+(const Vector3f &v) const
 	{
 		Vector3f tempV;
 
@@ -171,7 +165,7 @@ public:
 	}
 
 	// vector subtraction
-	Vector3f operator-(Vector3f v) const
+	Vector3f operator-(const Vector3f &v) const
 	{
 		Vector3f tempV;
 
@@ -183,7 +177,7 @@ public:
 	}
 
 	// vector negation
-	 const Vector3f operator-() const
+	 Vector3f operator-() const
 	 {
 		return Vector3f(-x, -y, -z);
 	 }
@@ -208,9 +202,8 @@ public:
 	//	return vector3f(k*v.x, k*v.y, k*v.z);
 	//}
 
-	/******************* destructor *******************/
-	~Vector3f() {	}
-
+	// no destructor: the implicit one is trivial, which keeps Vector3f
+	// a literal type (constexpr) that is copied with a plain move
 };
 
 
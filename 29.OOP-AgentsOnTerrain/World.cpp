@@ -0,0 +1,886 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ World Class
+//
+//	See World.h for the rationale
+//
+//	##########################################################
+
+#include <string.h>
+#include <algorithm>
+#include "World.h"
+
+// where snapshot agents are drawn when there is no instanced drawing,
+// in the colours of Predator/Prey/Snack::render()
+static const float speciesColours[NO_OF_SPECIES][3] = {
+  { 1.0f, 0.0f, 0.0f },
+  { 0.0f, 0.0f, 1.0f },
+  { 0.0f, 1.0f, 0.0f }
+};
+
+static void drawInstancePoints(SpeciesType species, const vector<AGENTINSTANCE> &instances)
+{
+  glPointSize(2.0f);
+  glColor3fv(speciesColours[species]);
+  glBegin(GL_POINTS);
+  for(size_t i=0; i<instances.size(); i++)
+    glVertex3f(instances[i].x, instances[i].y, instances[i].z);
+  glEnd();
+  glPointSize(1.0f);
+}
+
+// make room for count pointers in array, doubling so that it is rare
+template <class T>
+static void reserveArray(T **&array, int &capacity, int used, int count)
+{
+  if (count <= capacity) return;
+
+  int newCapacity = (capacity * 2 > count) ? capacity * 2 : count;
+  T **grown = new T*[newCapacity];
+  if (used > 0) memcpy(grown, array, used * sizeof(T*));
+  delete[] array;
+
+  array = grown;
+  capacity = newCapacity;
+}
+
+// update the agents of one species that are in [begin, end) of the
+// agents array, array[0] being agents[first]. The species classes are
+// final, so update() and everything it calls on the agent are direct
+// calls rather than one vtable lookup per agent. The agents push their
+// intents to interactions (their own buffer if NULL)
+template <class T>
+static void updateSpecies(T **array, int first, int count, int begin, int end, PositionBuffer *positions,
+  InteractionBuffer *interactions)
+{
+  int from = (begin > first) ? begin : first;
+  int to = (end < first + count) ? end : first + count;
+
+  for(int i=from; i<to; i++)
+  {
+    T *agent = array[i - first];
+    if (interactions != NULL) agent->getInteractions(interactions);
+    agent->update();
+    if (positions != NULL) positions->back[i] = agent->getPosition();
+  }
+}
+
+template <class T>
+static void renderSpecies(T **array, int count)
+{
+  for(int i=0; i<count; i++)
+    array[i]->render();
+}
+
+// cells of the spatial hash as wide as the seek distance, so seeking
+// visits 3x3 cells; below a unit the cells only add to the table, an
+// agent's search already reaches a unit further (the hash's padding)
+static float hashCellSize(float seekDistance)
+{
+  return (seekDistance > 1.0f) ? seekDistance : 1.0f;
+}
+
+// drop the dying from a species array, the others keep their order
+template <class T>
+static int removeDying(T **array, int count)
+{
+  int kept = 0;
+  for(int i=0; i<count; i++)
+    if (!array[i]->dying) array[kept++] = array[i];
+  return kept;
+}
+
+World::World(int predatorNo, int preyNo, int snackNo, unsigned int _seed)
+{
+  seed = _seed;
+
+  cout<<"*********************** Initialising Scene Utility ***********************"<<endl;
+  //  instantiate grid
+  float gridWidth = 100.0f;
+  float gridLength = 100.0f;
+  float gridSpacing = 10.0f;
+  grid = new Grid(gridWidth, gridLength, gridSpacing);
+
+  cout<<"*********************** Create a Terrain ***********************"<<endl;
+  terrain = new SimpleTerrain(4, 4, 1.0f, 25.0f, seed);
+
+  populate(predatorNo, preyNo, snackNo);
+}
+
+// a world on an existing grid and terrain (used by Checkpoint::restore)
+World::World(Grid *_grid, SimpleTerrain *_terrain, int predatorNo, int preyNo, int snackNo, unsigned int _seed)
+{
+  seed = _seed;
+  grid = _grid;
+  terrain = _terrain;
+
+  populate(predatorNo, preyNo, snackNo);
+}
+
+void World::populate(int predatorNo, int preyNo, int snackNo)
+{
+  noOfPredators = predatorNo;
+  noOfPreys = preyNo;
+  noOfSnacks = snackNo;
+  agentNo = predatorNo + preyNo + snackNo;
+  tick = 0;
+
+  seekDistance = 20.0f;
+  fieldOfView = -1.0f;
+  ownsLandscape = true;
+
+  threadPool = NULL;
+  positions = NULL;
+  renderAlpha = 1.0f;
+  snackSpin = 0.0f;
+
+  // one buffer until there are threads
+  interactions = new InteractionBuffer[1];
+  noOfInteractionBuffers = 1;
+  conflictRule = CONFLICT_FIRST_BY_ID;
+  noOfInteractions = 0;
+  noOfConflicts = 0;
+  noOfMeals = 0;
+
+  createAgents();
+
+  // only predators and preys move, they are the first agents in the array
+  batchKinematics = false;
+
+  // there may be no OpenGL context yet
+  agentRenderer = NULL;
+  instancedAgents = true;
+
+  viewCulling = false;
+  agentDetailDistance = 200.0f;
+  noOfVisibleAgents = agentNo;
+  hashCurrent = false;
+}
+
+void World::createAgents()
+{
+  cout<<"*********************** Initialising Agents ***********************"<<endl;
+  // the agents live in the pools, the arrays below only point at them
+  predatorPool = new AgentPool<Predator>();
+  preyPool = new AgentPool<Prey>();
+  snackPool = new AgentPool<Snack>();
+  pools[PREDATOR] = predatorPool;
+  pools[PREY] = preyPool;
+  pools[SNACK] = snackPool;
+
+  predatorPool->reserve(noOfPredators);
+  preyPool->reserve(noOfPreys);
+  snackPool->reserve(noOfSnacks);
+
+  // this needs not be instantiated
+  // the derived types are assigned to the array later
+  agentCapacity = agentNo;
+  agents = new Agent*[agentCapacity];
+
+  // derived classes
+  predatorCapacity = noOfPredators;
+  preyCapacity = noOfPreys;
+  snackCapacity = noOfSnacks;
+  predators = new Predator*[predatorCapacity];
+  preys = new Prey*[preyCapacity];
+  snacks = new Snack*[snackCapacity];
+
+  int firstPrey = noOfPredators;
+  int firstSnack = noOfPredators + noOfPreys;
+
+  // 1st Loop: create agents types first
+  cout<<"----- Creating Types"<< endl;
+  for(int i=0; i<agentNo; i++)
+  {
+    // randomise location of agents
+    int min = grid->getBottom();
+    int max = grid->getBottom() + grid->getBottom();
+
+    int newX = Random::range(seed, i, 0, STREAM_PLACE_X, max)-min;
+    int newZ = Random::range(seed, i, 0, STREAM_PLACE_Z, max)-min;
+
+    if(i<firstPrey)
+      predators[i] = predatorPool->create(i, newX, 0, newZ, 0.001f);
+    else if(i<firstSnack)
+      preys[i-firstPrey] = preyPool->create(i, newX, 0, newZ, 0.001f);
+    else
+      snacks[i-firstSnack] = snackPool->create(i, newX, 0, newZ, 0.0f);
+  }
+
+  // ids carry on from here for agents born later
+  nextId = agentNo;
+  noOfBirths = 0;
+  noOfDeaths = 0;
+
+  cout << "----- Deriving Types" << endl;
+  for(int i=0; i<agentNo; i++)
+  {
+    if(i<firstPrey)
+    {
+      agents[i] = predators[i];
+      agents[i]->speciesType = PREDATOR;
+    }
+    else if(i<firstSnack)
+    {
+      agents[i] = preys[i-firstPrey];
+      agents[i]->speciesType = PREY;
+    }
+    else
+    {
+      agents[i] = snacks[i-firstSnack];
+      agents[i]->speciesType = SNACK;
+    }
+    agents[i]->index = i;
+  }
+
+  spatialHash = new SpatialHash(grid, hashCellSize(seekDistance), agentNo);
+
+  cout << "----- Getting grid and agents to be accessible to all agents" << endl;
+  for(int i=0; i<agentNo; i++)
+    connect(agents[i]);
+}
+
+void World::connect(Agent *agent)
+{
+  agent->getGrid(grid);
+  agent->getAgents(agents, agentNo);
+  agent->getTerrain(terrain);
+  agent->getSpatialHash(spatialHash);
+  agent->getPositionBuffer(positions);
+  agent->getRandom(seed, &tick);
+  agent->getRenderAlpha(&renderAlpha);
+  agent->getPools(pools);
+  agent->getInteractions(&interactions[0]);
+}
+
+void World::spawn(SpeciesType species, float x, float z)
+{
+  BIRTH birth;
+  birth.species = species;
+  birth.x = x;
+  birth.z = z;
+  births.push_back(birth);
+}
+
+void World::kill(Agent *agent)
+{
+  if (agent->dying) return;		// killed twice in one tick
+
+  agent->dying = true;
+  deaths.push_back(agent);
+}
+
+// orders intents by type, then target, then the id of the agent, so
+// the buffers they came from (and so the threads) make no difference
+static bool interactionBefore(const INTERACTION &a, const INTERACTION &b)
+{
+  if (a.type != b.type) return a.type < b.type;
+  if (a.target != b.target) return a.target < b.target;
+  return a.actor < b.actor;
+}
+
+// after the tick, before births and deaths: every target goes to one of
+// the agents that wanted it (see ConflictRule), the others go without
+void World::resolveInteractions()
+{
+  resolving.clear();
+  for(int t=0; t<noOfInteractionBuffers; t++)
+  {
+    resolving.insert(resolving.end(), interactions[t].events.begin(), interactions[t].events.end());
+    interactions[t].clear();
+  }
+  if (resolving.empty()) return;
+
+  PROFILE("interactions");
+
+  sort(resolving.begin(), resolving.end(), interactionBefore);
+  noOfInteractions += resolving.size();
+
+  size_t first = 0;
+  while (first < resolving.size())
+  {
+    const INTERACTION &event = resolving[first];
+
+    // everybody who wants the same target in the same way
+    size_t last = first + 1;
+    while (last < resolving.size() && resolving[last].type == event.type && resolving[last].target == event.target)
+      last++;
+    int wanted = last - first;
+
+    Agent *target = agents[event.target];
+    int winner = 0;
+    if (conflictRule == CONFLICT_RANDOM_BY_SEED && wanted > 1)
+      winner = Random::range(seed, target->getID(), tick, STREAM_CONFLICT, wanted);
+    noOfConflicts += wanted - 1;
+
+    noOfMeals++;
+    target->isEaten(resolving[first + winner].actor);
+
+    first = last;
+  }
+}
+
+// between two ticks: the dead go back to their pools, the newborns
+// take their place at the end of their species
+void World::applyBirthsAndDeaths()
+{
+  // an eaten snack dies and a new one grows where it used to reappear
+  int min = grid->getBottom();
+  int max = grid->getBottom() + grid->getBottom();
+  for(int i=0; i<noOfSnacks; i++)
+  {
+    if (!snacks[i]->wasEaten()) continue;
+
+    int id = snacks[i]->getID();
+    kill(snacks[i]);
+    spawn(SNACK, Random::range(seed, id, tick, STREAM_RESPAWN_X, max)-min,
+                 Random::range(seed, id, tick, STREAM_RESPAWN_Z, max)-min);
+  }
+
+  if (births.empty() && deaths.empty()) return;
+
+  PROFILE("births and deaths");
+
+  noOfPredators = removeDying(predators, noOfPredators);
+  noOfPreys = removeDying(preys, noOfPreys);
+  noOfSnacks = removeDying(snacks, noOfSnacks);
+
+  for(size_t d=0; d<deaths.size(); d++)
+  {
+    Agent *agent = deaths[d];
+    if (agent->speciesType == PREDATOR) predatorPool->destroy((Predator*)agent);
+    else if (agent->speciesType == PREY) preyPool->destroy((Prey*)agent);
+    else snackPool->destroy((Snack*)agent);
+  }
+  noOfDeaths += deaths.size();
+  deaths.clear();		// keeps its capacity for the next tick
+
+  for(size_t b=0; b<births.size(); b++)
+  {
+    BIRTH &birth = births[b];
+    Agent *agent;
+
+    if (birth.species == PREDATOR)
+    {
+      reserveArray(predators, predatorCapacity, noOfPredators, noOfPredators + 1);
+      predators[noOfPredators++] = predatorPool->create(nextId, birth.x, 0, birth.z, 0.001f);
+      agent = predators[noOfPredators - 1];
+      predators[noOfPredators - 1]->setSenses(seekDistance, fieldOfView);
+    }
+    else if (birth.species == PREY)
+    {
+      reserveArray(preys, preyCapacity, noOfPreys, noOfPreys + 1);
+      preys[noOfPreys++] = preyPool->create(nextId, birth.x, 0, birth.z, 0.001f);
+      agent = preys[noOfPreys - 1];
+      preys[noOfPreys - 1]->setSenses(seekDistance, fieldOfView);
+    }
+    else
+    {
+      reserveArray(snacks, snackCapacity, noOfSnacks, noOfSnacks + 1);
+      snacks[noOfSnacks++] = snackPool->create(nextId, birth.x, 0, birth.z, 0.0f);
+      agent = snacks[noOfSnacks - 1];
+    }
+    nextId++;
+
+    agent->speciesType = birth.species;
+    connect(agent);
+
+    // it appears where it is born, it does not slide there
+    agent->placeAgentOnTerrain();
+    agent->savePrevious();
+  }
+  noOfBirths += births.size();
+  births.clear();
+
+  collectAgents();
+}
+
+// the agents array again from the species arrays
+void World::collectAgents()
+{
+  hashCurrent = false;		// the indices it holds are out of date
+
+  agentNo = noOfPredators + noOfPreys + noOfSnacks;
+  reserveArray(agents, agentCapacity, 0, agentNo);
+
+  int i = 0;
+  for(int k=0; k<noOfPredators; k++) agents[i++] = predators[k];
+  for(int k=0; k<noOfPreys; k++) agents[i++] = preys[k];
+  for(int k=0; k<noOfSnacks; k++) agents[i++] = snacks[k];
+
+  for(i=0; i<agentNo; i++)
+  {
+    agents[i]->index = i;
+    agents[i]->getAgents(agents, agentNo);
+  }
+
+  // the snapshot is indexed like the agents array
+  if (positions != NULL)
+  {
+    if (positions->size < agentNo)
+    {
+      delete positions;
+      positions = new PositionBuffer(agentCapacity);
+      for(i=0; i<agentNo; i++)
+        agents[i]->getPositionBuffer(positions);
+    }
+
+    for(i=0; i<agentNo; i++)
+      positions->front[i] = agents[i]->getPosition();
+  }
+}
+
+void World::setSenses(float distance, float fov)
+{
+  seekDistance = distance;
+  fieldOfView = fov;
+
+  for(int i=0; i<noOfPredators; i++) predators[i]->setSenses(distance, fov);
+  for(int i=0; i<noOfPreys; i++) preys[i]->setSenses(distance, fov);
+
+  // cells made for another seek distance would make seeking visit
+  // many more (or much fuller) cells, the hash is made again
+  if (hashCellSize(distance) != spatialHash->getCellSize())
+  {
+    delete spatialHash;
+    spatialHash = new SpatialHash(grid, hashCellSize(distance), agentNo);
+    for(int i=0; i<agentNo; i++)
+      agents[i]->getSpatialHash(spatialHash);
+    hashCurrent = false;		// empty until it is rebuilt
+  }
+}
+
+void World::setBatchKinematics(bool state)
+{
+  batchKinematics = state;
+}
+
+void World::setThreads(int threads)
+{
+  delete threadPool;
+  threadPool = NULL;
+  delete positions;
+  positions = NULL;
+
+  if (threads > 0)
+  {
+    threadPool = new ThreadPool(threads);
+    noOfInteractionBuffers = threads;
+
+    // the first snapshot is where everybody is now
+    positions = new PositionBuffer(agentNo);
+    for(int i=0; i<agentNo; i++)
+      positions->front[i] = agents[i]->getPosition();
+  }
+
+  for(int i=0; i<agentNo; i++)
+    agents[i]->getPositionBuffer(positions);
+
+  // updateParallel() hands each thread's buffer out again every tick
+  delete[] interactions;
+  if (threads <= 0) noOfInteractionBuffers = 1;
+  interactions = new InteractionBuffer[noOfInteractionBuffers];
+  for(int i=0; i<agentNo; i++)
+    agents[i]->getInteractions(&interactions[0]);
+}
+
+void World::setConflictRule(ConflictRule rule)
+{
+  conflictRule = rule;
+}
+
+void World::update()
+{
+  PROFILE("world update");
+
+  // heights edited since the last tick: the agents, perhaps on several
+  // threads, must only read the terrain
+  if (terrain->isDirty())
+    terrain->refresh();
+
+  // the state render() draws from when it is between two ticks
+  for(int i=0; i<agentNo; i++)
+    agents[i]->savePrevious();
+
+  if (threadPool != NULL)
+    updateParallel();
+  else if (batchKinematics)
+    updateBatch();
+  else
+  {
+    // bucket agents by position before they seek each other
+    spatialHash->rebuild(agents, agentNo);
+
+    PROFILE("agents update");
+    updateRange(0, agentNo, NULL);
+  }
+  hashCurrent = true;		// every path rebuilds it first
+
+  // what the agents wanted to do to each other, then the agents array
+  // (which only changes between ticks)
+  resolveInteractions();
+  applyBirthsAndDeaths();
+
+  tick++;
+}
+
+// agents[begin..end) species by species, which is the order of the
+// agents array (writes the new positions to positions->back if not NULL)
+void World::updateRange(int begin, int end, PositionBuffer *snapshot, InteractionBuffer *buffer)
+{
+  int firstPrey = noOfPredators;
+  int firstSnack = noOfPredators + noOfPreys;
+
+  updateSpecies(predators, 0, noOfPredators, begin, end, snapshot, buffer);
+  updateSpecies(preys, firstPrey, noOfPreys, begin, end, snapshot, buffer);
+  updateSpecies(snacks, firstSnack, noOfSnacks, begin, end, snapshot, buffer);
+}
+
+void World::updateBatch()
+{
+  int movers = noOfPredators + noOfPreys;
+  Population *motions[2] = { &predatorPool->motion, &preyPool->motion };
+
+  spatialHash->rebuild(agents, agentNo);
+
+  // decisions differ per species, one loop each
+  for(int i=0; i<noOfPredators; i++)
+    predators[i]->autonomy();
+  for(int i=0; i<noOfPreys; i++)
+    preys[i]->autonomy();
+
+  // movement is the same for everybody, done in one loop per pool
+  {
+    PROFILE("integrateMotion");
+    for(int m=0; m<2; m++)
+      motions[m]->integrateMotion();
+  }
+
+  // and so is skating on the terrain
+  {
+    PROFILE("sampleHeights");
+    for(int m=0; m<2; m++)
+      terrain->sampleHeights(motions[m]->position, motions[m]->size);
+  }
+
+  // snacks do not move, they only sit on the terrain until eaten
+  {
+    PROFILE("snacks update");
+    updateRange(movers, agentNo, NULL);
+  }
+}
+
+void World::updateParallel()
+{
+  int movers = noOfPredators + noOfPreys;
+
+  // agents are still where the front buffer says they are
+  spatialHash->rebuild(agents, agentNo);
+
+  // each agent reads the front buffer and writes only itself, back[i]
+  // and the interaction buffer of its thread
+  threadPool->parallelFor(movers, [this](int thread, int begin, int end)
+  {
+    PROFILE("movers range");
+    updateRange(begin, end, positions, &interactions[thread]);
+  });
+
+  // snacks go after all preys have eaten, as in the in-place loop
+  threadPool->parallelFor(agentNo - movers, [this, movers](int thread, int begin, int end)
+  {
+    PROFILE("snacks range");
+    updateRange(movers + begin, movers + end, positions, &interactions[thread]);
+  });
+
+  positions->swap();
+}
+
+void World::render(float alpha)
+{
+  renderAlpha = alpha;
+
+  {
+    PROFILE("grid render");
+    grid->render();
+  }
+  {
+    PROFILE("terrain render");
+    terrain->render(viewCulling ? &view : NULL);
+  }
+
+  PROFILE("agents render");
+  if (instancedAgents && agentRenderer == NULL)
+    agentRenderer = new AgentRenderer();
+
+  if (viewCulling)
+  {
+    cullAgents();
+
+    bool instanced = instancedAgents && agentRenderer->isReady();
+    if (instanced)
+      for(int i=0; i<noOfSnacks; i++)
+        snacks[i]->spin();
+
+    for(int s=0; s<NO_OF_SPECIES; s++)
+    {
+      if (instanced)
+      {
+        if (!nearAgents[s].empty()) agentRenderer->draw((SpeciesType)s, &nearAgents[s][0], nearAgents[s].size());
+        if (!farAgents[s].empty()) agentRenderer->drawPoints((SpeciesType)s, &farAgents[s][0], farAgents[s].size());
+      }
+      else
+      {
+        for(size_t i=0; i<nearAgents[s].size(); i++) nearAgents[s][i]->render();
+        for(size_t i=0; i<farAgents[s].size(); i++) farAgents[s][i]->render();
+      }
+    }
+    return;
+  }
+  noOfVisibleAgents = agentNo;
+
+  if (instancedAgents && agentRenderer->isReady())
+  {
+    // agents are stored by species, each species is one range of the array
+    for(int i=0; i<noOfSnacks; i++)
+      snacks[i]->spin();
+
+    agentRenderer->draw(PREDATOR, agents, noOfPredators);
+    agentRenderer->draw(PREY, agents + noOfPredators, noOfPreys);
+    agentRenderer->draw(SNACK, agents + noOfPredators + noOfPreys, noOfSnacks);
+    return;
+  }
+
+  // one at a time, species by species
+  renderSpecies(predators, noOfPredators);
+  renderSpecies(preys, noOfPreys);
+  renderSpecies(snacks, noOfSnacks);
+}
+
+void World::writeSnapshot(WorldSnapshot &snapshot)
+{
+  PROFILE("snapshot");
+
+  snapshot.tick = tick;
+
+  // agents born or dead since the last tick, the hash is of the old array
+  if (!hashCurrent)
+  {
+    spatialHash->rebuild(agents, agentNo);
+    hashCurrent = true;
+  }
+
+  int noOfCells = spatialHash->getRows() * spatialHash->getCols();
+  snapshot.cells.resize(noOfCells);
+  for(int s=0; s<NO_OF_SPECIES; s++)
+  {
+    snapshot.agents[s].clear();
+    snapshot.cellStart[s].resize(noOfCells + 1);
+  }
+
+  // cell by cell, as cullAgents() goes through them
+  AGENTSTATE state;
+  for(int cz=0; cz<spatialHash->getRows(); cz++)
+    for(int cx=0; cx<spatialHash->getCols(); cx++)
+    {
+      int c = cz * spatialHash->getCols() + cx;
+      cellBox(cx, cz, snapshot.cells[c]);
+
+      for(int s=0; s<NO_OF_SPECIES; s++)
+      {
+        snapshot.cellStart[s][c] = snapshot.agents[s].size();
+        int end = spatialHash->cellEnd((SpeciesType)s, cx, cz);
+        for(int k = spatialHash->cellBegin((SpeciesType)s, cx, cz); k < end; k++)
+        {
+          agents[spatialHash->item(k)]->getState(state);
+          snapshot.agents[s].push_back(state);
+        }
+      }
+    }
+
+  for(int s=0; s<NO_OF_SPECIES; s++)
+    snapshot.cellStart[s][noOfCells] = snapshot.agents[s].size();
+}
+
+// only the snapshot, the grid and the terrain are read (update() on another
+// thread only reads the grid and terrain too), the agents are not touched
+void World::render(const WorldSnapshot &snapshot, float alpha)
+{
+  {
+    PROFILE("grid render");
+    grid->render();
+  }
+  {
+    PROFILE("terrain render");
+    terrain->render(viewCulling ? &view : NULL);
+  }
+
+  PROFILE("agents render");
+  if (instancedAgents && agentRenderer == NULL)
+    agentRenderer = new AgentRenderer();
+
+  if (alpha > 1.0f) alpha = 1.0f;
+  snackSpin += 0.3f;
+
+  // as cullAgents(): cells out of sight are not looked into, near or far
+  // goes by the distance of the cell
+  for(int s=0; s<NO_OF_SPECIES; s++)
+  {
+    nearInstances[s].clear();
+    farInstances[s].clear();
+  }
+
+  for(size_t c=0; c<snapshot.cells.size(); c++)
+  {
+    bool near = true;
+    if (viewCulling)
+    {
+      if (!view.sees(snapshot.cells[c])) continue;
+      near = view.distance(snapshot.cells[c]) < agentDetailDistance;
+    }
+
+    for(int s=0; s<NO_OF_SPECIES; s++)
+    {
+      vector<AGENTINSTANCE> &list = near ? nearInstances[s] : farInstances[s];
+      const vector<AGENTSTATE> &states = snapshot.agents[s];
+      for(int k = snapshot.cellStart[s][c]; k < snapshot.cellStart[s][c+1]; k++)
+      {
+        const AGENTSTATE &state = states[k];
+        AGENTINSTANCE instance;
+        instance.x = state.prevX + (state.x - state.prevX) * alpha;
+        instance.y = state.prevY + (state.y - state.prevY) * alpha;
+        instance.z = state.prevZ + (state.z - state.prevZ) * alpha;
+        instance.heading = state.prevHeading + (state.heading - state.prevHeading) * alpha;
+        if (s == SNACK) instance.heading += snackSpin;
+        list.push_back(instance);
+      }
+    }
+  }
+
+  noOfVisibleAgents = 0;
+  for(int s=0; s<NO_OF_SPECIES; s++)
+    noOfVisibleAgents += nearInstances[s].size() + farInstances[s].size();
+
+  bool instanced = instancedAgents && agentRenderer->isReady();
+  for(int s=0; s<NO_OF_SPECIES; s++)
+  {
+    if (instanced)
+    {
+      if (!nearInstances[s].empty()) agentRenderer->draw((SpeciesType)s, &nearInstances[s][0], nearInstances[s].size());
+      if (!farInstances[s].empty()) agentRenderer->drawPoints((SpeciesType)s, &farInstances[s][0], farInstances[s].size());
+    }
+    else
+    {
+      drawInstancePoints((SpeciesType)s, nearInstances[s]);
+      drawInstancePoints((SpeciesType)s, farInstances[s]);
+    }
+  }
+}
+
+void World::setInstancedAgents(bool state)
+{
+  instancedAgents = state;
+}
+
+void World::setView(const Frustum &frustum)
+{
+  view = frustum;
+  viewCulling = true;
+}
+
+void World::clearView()
+{
+  viewCulling = false;
+}
+
+// the agents in the SpatialHash cells the view sees, near or far by
+// the distance of their cell, cells out of sight are not looked into
+void World::cullAgents()
+{
+  PROFILE("agents culling");
+
+  // agents born or dead since the last tick, the hash is of the old array
+  if (!hashCurrent)
+  {
+    spatialHash->rebuild(agents, agentNo);
+    hashCurrent = true;
+  }
+
+  BOUNDINGBOX box;
+  for(int s=0; s<NO_OF_SPECIES; s++)
+  {
+    nearAgents[s].clear();
+    farAgents[s].clear();
+  }
+  noOfVisibleAgents = 0;
+
+  for(int cz=0; cz<spatialHash->getRows(); cz++)
+    for(int cx=0; cx<spatialHash->getCols(); cx++)
+    {
+      cellBox(cx, cz, box);
+      if (!view.sees(box)) continue;
+
+      bool near = view.distance(box) < agentDetailDistance;
+      for(int s=0; s<NO_OF_SPECIES; s++)
+      {
+        vector<Agent*> &list = near ? nearAgents[s] : farAgents[s];
+        int end = spatialHash->cellEnd((SpeciesType)s, cx, cz);
+        for(int k = spatialHash->cellBegin((SpeciesType)s, cx, cz); k < end; k++)
+          list.push_back(agents[spatialHash->item(k)]);
+        noOfVisibleAgents += end - spatialHash->cellBegin((SpeciesType)s, cx, cz);
+      }
+    }
+}
+
+void World::cellBox(int cx, int cz, BOUNDINGBOX &box)
+{
+  // agents stand on the terrain, no taller than a snack (1)
+  float lowest, highest;
+  terrain->getHeightRange(lowest, highest);
+  box.minY = lowest - 1.0f;
+  box.maxY = highest + 2.0f;
+
+  // and their shapes reach up to 2 from where they stand
+  spatialHash->cellBounds(cx, cz, box.minX, box.minZ, box.maxX, box.maxZ);
+  box.minX -= 2.0f; box.minZ -= 2.0f;
+  box.maxX += 2.0f; box.maxZ += 2.0f;
+}
+
+World::~World()
+{
+  cout<<"---- deleting predators"<<endl;
+  delete predatorPool;
+  delete[] predators;
+
+  cout<<"---- deleting preys"<<endl;
+  delete preyPool;
+  delete[] preys;
+
+  cout<<"---- deleting snacks"<<endl;
+  delete snackPool;
+  delete[] snacks;
+
+  cout<<"---- deleting agents"<<endl;
+  delete[] agents; // the agents themselves were deleted with their pools above
+
+  if (ownsLandscape)
+  {
+    cout<<"---- deleting grid"<<endl;
+    delete grid;
+
+    cout<<"---- deleting terrain"<<endl;
+    delete terrain;
+  }
+
+  cout<<"---- deleting spatial hash"<<endl;
+  delete spatialHash;
+
+
+  delete threadPool;
+  delete positions;
+  delete[] interactions;
+
+  // only if render() has built it, i.e. there is an OpenGL context
+  delete agentRenderer;
+}
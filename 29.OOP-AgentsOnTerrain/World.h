@@ -0,0 +1,181 @@
+//	##########################################################
+//	By Eugene Ch'ng | www.complexity.io | 2018
+//	Email: genechng@gmail.com
+//	----------------------------------------------------------
+//	A C++ World Class
+//
+//	The World owns everything the simulation is made of: the Grid
+//	boundary, the SimpleTerrain, the predator/prey/snack population
+//	and the SpatialHash used for seeking.
+//
+//	Building and stepping the world needs no window or OpenGL
+//	context, so the same World is used by main.cpp (with SDL and
+//	OpenGL) and by Headless.cpp (batch runs on servers).
+//	Only render() needs an OpenGL context. Given a view (setView),
+//	render() leaves out the terrain chunks and the SpatialHash cells
+//	of agents the camera cannot see, and draws agents far away as
+//	points.
+//
+//	Agents are born and die between ticks: spawn() and kill() (called
+//	from the thread that calls update()) are queued and applied once
+//	the tick is over, so that during a tick the agents array stays as
+//	it is. The agents live in one AgentPool
+//	per species, and remember each other by AgentHandle.
+//
+//	The drawing can also run on a thread of its own: writeSnapshot()
+//	copies where the agents are after a tick, cell by cell, and
+//	render(snapshot) draws the cells in sight from that copy, so it
+//	does not read the agents while update() moves them (see main.cpp).
+//	Only update() refreshes edited terrain; the drawing uploads the
+//	copies of the tiles it published (see SimpleTerrain.h) and reads
+//	the grid, which does not change.
+//
+//	Agents do not change each other during a tick either: eating is
+//	an intent in an InteractionBuffer (one per thread), resolved after
+//	the tick by resolveInteractions().
+//
+//	##########################################################
+
+#ifndef WORLD_H
+#define WORLD_H
+
+#include <vector>
+#include "OGLUtil.h"
+#include "Grid.h"
+#include "SimpleTerrain.h"
+#include "SpatialHash.h"
+#include "PositionBuffer.h"
+#include "ThreadPool.h"
+#include "AgentRenderer.h"
+#include "AgentPool.h"
+#include "Interaction.h"
+#include "Frustum.h"
+#include "Snapshot.h"
+#include "Agent.h"
+#include "Predator.h"
+#include "Prey.h"
+#include "Snack.h"
+
+/****************************** PROTOTYPES ******************************/
+class World
+{
+public:
+	Grid *grid;
+	SimpleTerrain *terrain;
+	SpatialHash *spatialHash;
+
+	// all agents, predators first, then preys, then snacks
+	Agent **agents;
+	int agentNo;
+
+	// derived classes
+	Predator **predators;
+	Prey **preys;
+	Snack **snacks;
+	int noOfPredators, noOfPreys, noOfSnacks;
+
+	// the agents themselves, one pool per species (pools[speciesType])
+	AgentPool<Predator> *predatorPool;
+	AgentPool<Prey> *preyPool;
+	AgentPool<Snack> *snackPool;
+	AgentPoolBase *pools[NO_OF_SPECIES];
+	int nextId;				// id of the next agent born, ids are never reused
+	long noOfBirths, noOfDeaths;		// since the world was made
+
+	// how far and how wide predators and preys seek, newborns included
+	float seekDistance, fieldOfView;
+
+	// false when the grid and terrain are shared with other worlds
+	// (see Ensemble.cpp), whoever made them deletes them
+	bool ownsLandscape;
+
+	long tick;				// number of updates so far
+	unsigned int seed;		// every random number in the world derives from it
+
+	// batch kinematics: every predator and prey decides first, then each
+	// species moves together in the Population of its pool (off by
+	// default, which keeps the agent-by-agent update of the original loop)
+	bool batchKinematics;
+
+	// parallel stepping: agents see each other in last tick's positions
+	// (a PositionBuffer) and are updated by a ThreadPool, the result is the
+	// same for any number of threads (NULL when off, the default)
+	ThreadPool *threadPool;
+	PositionBuffer *positions;
+
+	// instanced drawing: one draw call per species instead of one
+	// render() per agent, built by the first render() (needs OpenGL)
+	AgentRenderer *agentRenderer;
+	bool instancedAgents;
+
+	// what the camera sees, nothing outside it is drawn (off until
+	// setView), agents beyond agentDetailDistance are drawn as points
+	Frustum view;
+	bool viewCulling;
+	float agentDetailDistance;
+	vector<Agent*> nearAgents[NO_OF_SPECIES], farAgents[NO_OF_SPECIES];
+	int noOfVisibleAgents;		// in the last render()
+	bool hashCurrent;		// spatialHash still indexes the agents array as it is
+	void cullAgents();
+	void cellBox(int cx, int cz, BOUNDINGBOX &box);		// where the agents of a cell are drawn
+
+	// how far between the last tick and the next the agents are drawn,
+	// 1 draws them where they are (see SimulationClock.h)
+	float renderAlpha;
+
+	// drawing from a snapshot: the instances of the visible agents, and
+	// how far the snacks have turned (Snack::spin() is per frame drawn)
+	vector<AGENTINSTANCE> nearInstances[NO_OF_SPECIES], farInstances[NO_OF_SPECIES];
+	float snackSpin;
+
+	// births and deaths asked for during a tick
+	struct BIRTH
+	{
+		SpeciesType species;
+		float x, z;
+	};
+	vector<BIRTH> births;
+	vector<Agent*> deaths;
+
+	// intents of the agents during a tick, one buffer per thread of the
+	// update ([0] for the in-place and batch loops)
+	InteractionBuffer *interactions;
+	int noOfInteractionBuffers;
+	vector<INTERACTION> resolving;		// all buffers together, sorted
+	ConflictRule conflictRule;
+	long noOfInteractions, noOfConflicts;		// intents, and those another agent won
+	long noOfMeals;		// snacks eaten
+
+	// the arrays above hold this many before they are reallocated
+	int agentCapacity, predatorCapacity, preyCapacity, snackCapacity;
+
+	void connect(Agent *agent);		// give an agent access to the world
+	void resolveInteractions();
+	void applyBirthsAndDeaths();
+	void collectAgents();
+
+	World(int predatorNo, int preyNo, int snackNo, unsigned int _seed = 1);
+	World(Grid *_grid, SimpleTerrain *_terrain, int predatorNo, int preyNo, int snackNo, unsigned int _seed);
+	~World();
+
+	void populate(int predatorNo, int preyNo, int snackNo);
+	void createAgents();
+	void update();		// advance every agent by one tick
+	void updateRange(int begin, int end, PositionBuffer *snapshot, InteractionBuffer *buffer = NULL);
+	void spawn(SpeciesType species, float x, float z);		// born after this tick
+	void kill(Agent *agent);		// gone after this tick
+	void updateBatch();
+	void setSenses(float distance, float fov);		// 20 and -1 unless set
+	void setConflictRule(ConflictRule rule);		// CONFLICT_FIRST_BY_ID unless set
+	void setBatchKinematics(bool state);
+	void updateParallel();
+	void setThreads(int threads);		// 0 returns to the in-place loop
+	void render(float alpha = 1.0f);		// draw grid, terrain and agents (needs OpenGL)
+	void writeSnapshot(WorldSnapshot &snapshot);		// after update(), on its thread
+	void render(const WorldSnapshot &snapshot, float alpha);		// may run while update() does
+	void setInstancedAgents(bool state);		// true (the default) draws each species at once
+	void setView(const Frustum &frustum);		// before render(), every frame the camera moves
+	void clearView();		// draw everything again
+};
+
+#endif
@@ -13,7 +13,22 @@
 //  How to compile:
 //  note that we are now using both SDL2 and OpenGL, thus the -l for all libraries
 //  we are also using multiple cpp files
-//  sudo g++ -I/usr/include/ main.cpp Camera.cpp SimpleTerrain.cpp Agent.cpp Predator.cpp Prey.cpp Snack.cpp Grid.cpp -o main -L/usr/lib -lSDL2 -lGL -lGLU
+//  sudo g++ -I/usr/include/ main.cpp Camera.cpp SimpleTerrain.cpp Agent.cpp Predator.cpp Prey.cpp Snack.cpp Grid.cpp SpatialHash.cpp Population.cpp ThreadPool.cpp World.cpp AgentRenderer.cpp SimulationClock.cpp Profiler.cpp -o main -L/usr/lib -lSDL2 -lGL -lGLU -pthread
+//
+//  press P to switch the profiler on and off, the summary is printed
+//  and profile.json (chrome://tracing) written when the program ends
+//  press I to switch between instanced agent drawing and plain coloured points
+//  (a point per agent, in the colour of its species)
+//  press C to switch view culling on and off, with it on only what the camera
+//  sees is drawn and far terrain and agents are drawn with less detail
+//
+//  the simulation runs on a thread of its own, 60 ticks per second of real
+//  time whatever the frame rate (see SimulationClock.h), press F to
+//  fast-forward 10, then 100 ticks at a time as fast as they run, and back
+//  to real time. After each batch of ticks it publishes a WorldSnapshot
+//  (Snapshot.h) through a TripleBuffer; this thread handles the keys and
+//  draws the latest snapshot at 60 frames per second, so a slow frame does
+//  not hold up the model and a slow tick does not hold up the window
 //
 // -I define the path to the includes folder
 // -L define the path to the library folder
@@ -22,19 +37,23 @@
 
 #include <iostream>
 #include <string>
+#include <atomic>
+#include <thread>
+#include <chrono>
 #include "OGLUtil.h"
 #include "Grid.h"
 #include "Camera.h"
-#include "SimpleTerrain.h"
-#include "Agent.h"
-#include "Predator.h"
-#include "Prey.h"
-#include "Snack.h"
+#include "World.h"
+#include "SimulationClock.h"
+#include "Profiler.h"
+#include "Snapshot.h"
+#include "TripleBuffer.h"
 
 using namespace std;
 
 /****************************** PROTOTYPES ******************************/
 void checkKeyPress();
+void simulate();
 void initOpenGL();
 int setViewport( int width, int height );
 void renderScene();
@@ -59,122 +78,34 @@ GLfloat matSpecular[] = {1.0f,1.0f, 1.0f, 1.0f,};
 
 /****************************** GLOBAL VARIABLES ******************************/
 SDL_Event event;                // declare an SDL event
-bool isRunning;                 // main loop state
+atomic<bool> isRunning;         // main loop state, both threads stop when false
 
 SDL_Window* displayWindow;
 SDL_Renderer* displayRenderer;
 SDL_RendererInfo displayRendererInfo;
 
 Camera *camera;     // CAMERA
-Grid *grid;			    // declare grid
+World *world;       // grid, terrain and agents
+SimulationClock *simClock;  // how many ticks each frame runs (simulation thread)
+atomic<int> fastForward;    // ticks at a time asked for by the F key, 0 for real time
+TripleBuffer<WorldSnapshot> *snapshots;   // from the simulation thread to this one
+bool profiled = false;  // the profiler was switched on at some point
+bool culling = true;    // draw only what the camera sees (see Frustum.h)
 
 // background colour starts with black
 float r, g, b = 0.0f;
 
-// ----------------------- Terrain
-SimpleTerrain *terrain;
-
 /****************************** MAIN METHOD ******************************/
 int main(int argc, char**argv)
 {
-    cout<<"*********************** Initialising Scene Utility ***********************"<<endl;
-    //  instantiate grid
-    float gridWidth = 100.0f;
-    float gridLength = 100.0f;
-    float gridSpacing = 10.0f;
-    grid = new Grid(gridWidth, gridLength, gridSpacing);
-
     // instantiating the camera
     camera = new Camera(Vector3f(0.0f, 30.0f, 60.0f), Vector3f(0.0f, 0.0f, -1.0f), 0.2f, 3.0f, 20.0f);
 
-    cout<<"*********************** Create a Terrain ***********************"<<endl;
-    terrain = new SimpleTerrain(4, 4, 1.0f, 25.0f);
-
-    cout<<"*********************** Initialising Agents ***********************"<<endl;
-    // instantiate n agents and assign them arbitrary speed
-    int agentNo = 12;
-
-    // this needs not be instantiated
-    // the derived types are assigned to the array later
-    Agent **agents = new Agent*[agentNo];
-    // for(int i=0; i<agentNo; i++)
-    //   agents[i] = new Agent(1, 0, 0, 0, 0.001f);
-
-    // derived classes
-    Predator **predators = new Predator*[2];
-    Prey **preys = new Prey*[4];
-    Snack **snacks = new Snack*[6];
-
-    // 1st Loop: create agents types first
-    cout<<"----- Creating Types"<< endl;
-    for(int i=0; i<agentNo; i++)
-    {
-      if(i<2)
-      {
-        // randomise location of snacks
-    		int min = grid->getBottom();
-    		int max = grid->getBottom() + grid->getBottom();
-
-    		int newX = (rand()%max)-min;
-    		int newZ = (rand()%max)-min;
-        //cout<<"creating predator "<<i<<endl;
-        predators[i] = new Predator(i, newX, 0, newZ, 0.001f);
-      }
-      else if(i>=2 && i<6)
-      {
-        // randomise location of snacks
-    		int min = grid->getBottom();
-    		int max = grid->getBottom() + grid->getBottom();
-
-    		int newX = (rand()%max)-min;
-    		int newZ = (rand()%max)-min;
-        //cout<<"creating prey "<<i-2<<endl;
-        preys[i-2] = new Prey(i, newX, 0, newZ, 0.001f);
-      }
-      else if(i>=6)
-      {
-        // randomise location of snacks
-        int min = grid->getBottom();
-    		int max = grid->getBottom() + grid->getBottom();
-
-    		int newX = (rand()%max)-min;
-    		int newZ = (rand()%max)-min;
-
-        //cout<<"creating snacks "<<i-6<<endl;
-        snacks[i-6] = new Snack(i, newX, 0, newZ, 0.0f);
-      }
-    }
+    // the world builds the grid, terrain and 2 predators, 4 preys, 6 snacks
+    world = new World(2, 4, 6);
 
-    cout << "----- Deriving Types" << endl;
-    for(int i=0; i<agentNo; i++)
-    {
-      if(i<2)
-      {
-        cout << "-- deriving predators["<<i<<"] "<<predators[i]<<endl;
-        agents[i] = predators[i];   // fishes[i] is the address
-        agents[i]->speciesType = PREDATOR;
-      }
-      else if(i>=2 && i<6)
-      {
-        cout << "-- deriving preys["<<i<<"] "<<preys[i-2]<<endl;
-        agents[i] = preys[i-2];
-        agents[i]->speciesType = PREY;
-      }
-      else if(i>=6)
-      {
-        cout << "-- deriving snacks["<<i<<"] "<<snacks[i-6]<<endl;
-        agents[i] = snacks[i-6];
-        agents[i]->speciesType = SNACK;
-      }
-    }
-
-    cout << "----- Getting grid and agents to be accessible to all agents" << endl;
-    for(int i=0; i<agentNo; i++)
-    {
-      agents[i]->getGrid(grid);
-      agents[i]->getAgents(agents, agentNo);
-      agents[i]->getTerrain(terrain);
-    }
+    // ticks of 1/60 s, at most 5 per frame when catching up
+    simClock = new SimulationClock(1.0 / 60.0, 5);
 
     cout<<"*********************** Begin SDL OpenGL ***********************"<<endl;
 
@@ -186,6 +117,7 @@ int main(int argc, char**argv)
 
     // set states
     isRunning = true;
+    fastForward = 0;
 
     // initialise SDL Video out
     cout<<"-------- Initialise SDL"<<endl;
@@ -218,6 +150,13 @@ int main(int argc, char**argv)
     // note that without using GLUT, we are now able to control
     // everything which runs within the loop using our own implementation
 
+    // the first snapshot before anything moves, then the model runs on its own
+    snapshots = new TripleBuffer<WorldSnapshot>();
+    world->writeSnapshot(snapshots->getBack());
+    snapshots->getBack().wallTime = SDL_GetTicks() / 1000.0;
+    snapshots->publish();
+    thread simulation(simulate);
+
     int frameRate = 1000 / 60;
     Uint32 timeStart = SDL_GetTicks();
     float px = 0.0f;
@@ -225,77 +164,70 @@ int main(int argc, char**argv)
         checkKeyPress();
 
         // The while loop runs too quickly on most systems which can hang
-        // most machines. The code below keeps the update consistent
-        // increase the frameRate above to slow down the simulation
+        // most machines. The code below limits how often a frame is drawn,
+        // the simulation thread decides how many ticks it runs
         if (SDL_GetTicks() >= timeStart + frameRate)
         {
           timeStart = SDL_GetTicks();
+          PROFILE("frame");
           //cout<<"timestart:"<<timeStart<<endl;
           glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // Clear the screen | depth buffer
           glLoadIdentity();
 
           // ------------------ START ALL UPDATES AND RENDERING HERE
-          camera->update();
+          {
+            PROFILE("camera update");
+            camera->update();
             //void gluLookAt(	GLdouble eyeX, GLdouble eyeY,	GLdouble eyeZ, GLdouble centerX,GLdouble centerY,	GLdouble centerZ,	GLdouble upX,	GLdouble upY,	GLdouble upZ);
             gluLookAt(camera->x, camera->y, camera->z, camera->tx, camera->ty, camera->tz, 0.0f, 1.0f, 0.0f);
+            if (culling) world->setView(camera->getFrustum());
+          }
 
           // we need to draw the components of the world in relation
           // to the grid's matrix stack, therefore the push and pop here to
           // couple all of them together
           glPushMatrix();
-            grid->render();
-            terrain->render();
-
-            // agents update
-            for(int i=0; i<agentNo; i++)
-            {
-              agents[i]->update();
-              agents[i]->render();
-            }
+            // the latest complete snapshot, drawn between its last two
+            // ticks, as far as real time has gone since it was published
+            snapshots->update();
+            const WorldSnapshot &snapshot = snapshots->getFront();
+            float alpha = (SDL_GetTicks() / 1000.0 - snapshot.wallTime) / simClock->getDt();
+            world->render(snapshot, alpha);
           glPopMatrix();
 
           // Update window with OpenGL rendering
-          SDL_GL_SwapWindow(displayWindow);
+          {
+            PROFILE("swap window");
+            SDL_GL_SwapWindow(displayWindow);
+          }
 
           // ------------------ END ALL UPDATES AND RENDERING HERE
         }
     }
 
+    simulation.join();
     cout<<"------- SIMULATION BLOCK ENDED"<<endl;
 
+    if (profiled)
+    {
+      Profiler::printSummary();
+      Profiler::writeChromeTrace("profile.json");
+    }
+
     // clear the screen to default
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
     cout<<"------- Cleaning Up Memory"<<endl;
 
-    cout<<"---- deleting predators"<<endl;
-    // for(int i = 0; i < 2; i++)
-    //   predators[i]->~Predator();
-    delete[] predators;
-
-    cout<<"---- deleting preys"<<endl;
-    // for(int i = 0; i < 4; i++)
-    //   preys[i]->~Prey();
-    delete[] preys;
-
-    cout<<"---- deleting snacks"<<endl;
-    // for(int i = 0; i < 6; i++)
-    //   snacks[i]->~Snack();
-    delete[] snacks;
-
-    cout<<"---- deleting agents"<<endl;
-    // for(int i = 0; i < agentNo; i++)
-    //   delete agents[i]; // calls each ~Agent()
-    delete[] agents; // delete the heap memory
-
-    cout<<"---- deleting grid"<<endl;
-    delete grid;
+    cout<<"---- deleting world"<<endl;
+    delete world;
 
     cout<<"---- deleting camera"<<endl;
     delete camera;
 
-    cout<<"---- deleting terrain"<<endl;
-    delete terrain;
+    cout<<"simulated "<<simClock->getSimulatedTime()<<" s, "<<simClock->getDroppedTicks()<<" ticks dropped catching up"<<endl;
+    delete simClock;
+    delete snapshots;
 
     // Destroy window
     SDL_DestroyWindow(displayWindow);
@@ -312,6 +244,33 @@ int main(int argc, char**argv)
    return 0;
 }
 
+// the simulation thread: ticks as real time (or fast-forward) asks for,
+// then hands a snapshot of them to the drawing
+void simulate()
+{
+  while (isRunning)
+  {
+    int k = fastForward;
+    if (k != simClock->getFastForward()) simClock->setFastForward(k);
+
+    int ticks = simClock->advance(SDL_GetTicks() / 1000.0);
+    if (ticks == 0)
+    {
+      // not yet time for the next tick
+      this_thread::sleep_for(chrono::milliseconds(1));
+      continue;
+    }
+
+    for(int t=0; t<ticks; t++)
+      world->update();
+
+    WorldSnapshot &snapshot = snapshots->getBack();
+    world->writeSnapshot(snapshot);
+    snapshot.wallTime = SDL_GetTicks() / 1000.0;
+    snapshots->publish();
+  }
+}
+
 void setupAmbientLight()
 {
 
@@ -392,6 +351,28 @@ void checkKeyPress()
           // cout<<"camera pitch down"<<endl;
           camera->pitchUp();
         }
+         if ( event.key.keysym.sym == SDLK_p )
+        {
+          Profiler::setEnabled(!Profiler::isEnabled());
+          profiled = true;
+        }
+         if ( event.key.keysym.sym == SDLK_i )
+        {
+          world->setInstancedAgents(!world->instancedAgents);
+        }
+         if ( event.key.keysym.sym == SDLK_c )
+        {
+          culling = !culling;
+          if (!culling) world->clearView();
+          cout<<"view culling: "<<(culling ? "on" : "off")<<endl;
+        }
+         if ( event.key.keysym.sym == SDLK_f )
+        {
+          // real time -> 10 -> 100 ticks at a time -> real time
+          int k = fastForward;
+          fastForward = (k == 0 ? 10 : (k == 10 ? 100 : 0));
+          cout<<"fast-forward: "<<fastForward<<" ticks at a time"<<endl;
+        }
       }
 
       // --------------------------- KEYUP HANDLER
@@ -443,7 +424,8 @@ int setViewport( int width, int height )
     // Calculate The Aspect Ratio Of The Window
     // gluPerspective(	GLdouble fovy, GLdouble aspect, GLdouble zNear, GLdouble zFar);
     //gluPerspective(45.0f, ratio, 0.1f, 100.0f);
-    gluPerspective(45.0f, (GLfloat)width/(GLfloat)height, 0.1f, 5000.0f);    // Calculate The Aspect Ratio Of The Window
+    // the camera keeps the perspective for its view frustum
+    camera->setPerspective(45.0f, (GLfloat)width/(GLfloat)height, 0.1f, 5000.0f);    // Calculate The Aspect Ratio Of The Window
 
     // use glu function to set a camera looking at
     // void gluLookAt(	GLdouble eyeX, GLdouble eyeY, GLdouble eyeZ,